@@ -1,909 +1,586 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
-#include <unistd.h>
 #include <time.h>
 #include <string.h>
 #include <signal.h>
+#include <stdatomic.h>
 #include <errno.h>
+#include <math.h>
 
-#define TIMEOUT_QUEDA 90        
-#define TEMPO_ALERTA 60        
-#define TIMEOUT_BACKOFF 6   
+#include "simulador.h"
 
-#define NUM_PISTAS 3           
-#define NUM_PORTOES 5          
-#define CAPACIDADE_TORRE 2      
-
-#define INTERVALO_MIN_MS 500    
-#define INTERVALO_MAX_MS 1500   
-
-#define TEMPO_POUSO_MIN 3       
-#define TEMPO_POUSO_VAR 6       
-#define TEMPO_DESEMB_MIN 3      
-#define TEMPO_DESEMB_VAR 5      
-#define TEMPO_DECOL_MIN 2       
-#define TEMPO_DECOL_VAR 4       
-
-#define MAX_AVIOES 1000
-#define VOO_DOMESTICO 0
-#define VOO_INTERNACIONAL 1
+#define MAX_PARALELO 32
+#define MAX_AVALIADOS 512
+#define MAX_REPLICACOES 1000
+#define MIN_REPLICACOES 3
 
 typedef struct {
-    pthread_mutex_t mutex;
-    pthread_cond_t cond;
-    pthread_cond_t cond_dom;  
-    int available;
-    int waiting_dom, waiting_int;
-    time_t oldest_dom_time;
-} resource_t;
-
+    int pistas, portoes, torre;
+    int total, sucessos, quedas;
+    int alertas, starvation;
+    long long espera_p50, espera_p95, espera_p99;
+    int ok;
+} resultado_t;
+
+// Uma simulação candidata ou replicação executando em sua própria thread.
 typedef struct {
-    int id, type;
-    pthread_t thread_id;
-    time_t tempo_inicio;
-    int estado; 
-} airplane_t;
-
-resource_t pistas, portoes, torre;
-airplane_t avioes[MAX_AVIOES];
-pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
-int total_avioes = 0, sucessos = 0, quedas = 0, ativos = 0;
-int domesticos = 0, internacionais = 0;
-int alertas_criticos = 0, deadlocks_detectados = 0, starvation_casos = 0;
-int preempcoes_realizadas = 0; 
-int deadlocks_evitados = 0; 
-int deadlocks_resolvidos = 0; 
-int num_pistas = NUM_PISTAS, num_portoes = NUM_PORTOES, capacidade_torre = CAPACIDADE_TORRE, tempo_sim = 300;
-int intervalo_min = INTERVALO_MIN_MS;
-int intervalo_max = INTERVALO_MAX_MS;
-int simulation_running = 1, airplane_counter = 0;
-time_t start_time;
-
-typedef struct critical_airplane {
-    int aviao_id;
-    time_t tempo_critico;
-    struct critical_airplane* next;
-} critical_airplane_t;
-
-critical_airplane_t* critical_list = NULL;
-pthread_mutex_t critical_mutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t avioes_mutex = PTHREAD_MUTEX_INITIALIZER; 
-
-typedef struct resource_holder {
-    int aviao_id;
-    int recurso_tipo; 
-    struct resource_holder* next;
-} resource_holder_t;
-
-typedef struct waiting_thread {
-    int aviao_id;
-    int recurso_tipo;
-    time_t tempo_espera; 
-    struct waiting_thread* next;
-} waiting_thread_t;
-
-resource_holder_t* pistas_holders = NULL;
-resource_holder_t* portoes_holders = NULL; 
-resource_holder_t* torre_holders = NULL;
-waiting_thread_t* waiting_threads = NULL;
-
-pthread_mutex_t deadlock_mutex = PTHREAD_MUTEX_INITIALIZER;
+    simulacao_t* sim;
+    pthread_t tid;
+    unsigned semente;
+    int ocupada, concluida;
+} execucao_t;
+
+simulacao_t* modelo = NULL;
+simulacao_t* volatile simulacoes_ativas[MAX_PARALELO];
+volatile sig_atomic_t interrompido = 0;
+pthread_mutex_t execucoes_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t execucoes_cond = PTHREAD_COND_INITIALIZER;
+const char* prefixo_exportacao = NULL;
+const char* arquivo_retomada = NULL;
+
+int modo_planejador = 0;
+const char* meta_metrica = "quedas";
+double meta_limite = 1.0;
+int max_pistas = 10, max_portoes = 16, max_torre = 6;
+int custo_recurso[3] = {1, 1, 1};
+int paralelo = 4;
+resultado_t avaliados[MAX_AVALIADOS];
+int num_avaliados = 0;
+int limite_atingido = 0;
+
+int modo_replicacao = 0;
+int max_replicacoes = 30;
+double precisao_replicacao = 1.0;
+
+// Os tratadores só rodam na thread principal (as das execuções nascem com
+// SIGINT e SIGUSR1 bloqueados), que é também quem tira as simulações da
+// lista antes de destruí-las: um tratador nunca usa uma já liberada. Na
+// execução simples as threads da simulação terminam antes da destruição.
+void checkpoint_handler(int sig __attribute__((unused))) {
+    for (int i = 0; i < MAX_PARALELO; i++) {
+        simulacao_t* sim = simulacoes_ativas[i];
+        if (sim != NULL) simulacao_checkpoint(sim);
+    }
+}
 
-void init_resource(resource_t* res, int capacity, int is_torre);
-int acquire_res(resource_t* res, int type, int timeout, int is_torre, int aviao_id, time_t tempo_inicio);
-int acquire_with_backoff(resource_t* res1, resource_t* res2, int type, int is_torre1, int is_torre2, int aviao_id, time_t tempo_inicio);
-int acquire_three_resources(resource_t* res1, resource_t* res2, resource_t* res3, int type, int is_torre1, int is_torre2, int is_torre3, int aviao_id, time_t tempo_inicio);
-void release_res(resource_t* res, int type, int is_torre, int aviao_id);
-void* airplane_thread(void* arg);
-void* monitor_thread(void* arg);
-void log_msg(const char* msg);
-void update_stats(int status, int type);
+void signal_handler(int sig __attribute__((unused))) {
+    interrompido = 1;
+    for (int i = 0; i < MAX_PARALELO; i++) {
+        simulacao_t* sim = simulacoes_ativas[i];
+        if (sim != NULL) simulacao_encerrar(sim);
+    }
+}
 
-void add_to_critical_list(int aviao_id, time_t tempo_critico);
-void remove_from_critical_list(int aviao_id);
-int check_preemption_needed();
-int force_preemption(int critical_aviao_id);
-int force_preemption_by_id(int victim_id);  
-void* aging_thread(void* arg);
+void retirar_ativa(int slot) {
+    simulacoes_ativas[slot] = NULL;
+    atomic_signal_fence(memory_order_seq_cst);
+}
 
-void add_resource_holder(int aviao_id, int recurso_tipo);
-void remove_resource_holder(int aviao_id, int recurso_tipo);
-void add_waiting_thread(int aviao_id, int recurso_tipo);
-void remove_waiting_thread(int aviao_id);
-int detect_deadlock();
-int resolve_deadlock(int aviao1_id, int aviao2_id); 
-void* deadlock_detection_thread(void* arg);
+void* execucao_thread(void* arg) {
+    execucao_t* e = arg;
+    simulacao_executar(e->sim);
+    
+    pthread_mutex_lock(&execucoes_mutex);
+    e->concluida = 1;
+    pthread_cond_broadcast(&execucoes_cond);
+    pthread_mutex_unlock(&execucoes_mutex);
+    return NULL;
+}
 
-void log_msg(const char* msg) {
-    time_t now = time(NULL);
-    struct tm *tm = localtime(&now);
-    printf("[%02d:%02d:%02d] %s\n", tm->tm_hour, tm->tm_min, tm->tm_sec, msg);
-    fflush(stdout);
+// Clona a configuração da linha de comando com outras capacidades e outra
+// semente e executa em paralelo, sem saída, no mesmo processo.
+int iniciar_candidato(execucao_t* e, int slot, const int config[3], unsigned semente_candidato) {
+    e->sim = simulacao_clonar(modelo);
+    if (e->sim == NULL) return -1;
+    
+    simulacao_config_t* cfg = simulacao_config(e->sim);
+    cfg->pistas = config[0];
+    cfg->portoes = config[1];
+    cfg->torre = config[2];
+    cfg->semente = semente_candidato;
+    cfg->saida = NULL;
+    cfg->trace = NULL;
+    cfg->checkpoint = NULL;
+    e->semente = semente_candidato;
+    e->concluida = 0;
+    
+    sigset_t sinais, anteriores;
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGINT);
+    sigaddset(&sinais, SIGUSR1);
+    simulacoes_ativas[slot] = e->sim;
+    pthread_sigmask(SIG_BLOCK, &sinais, &anteriores);
+    int rc = pthread_create(&e->tid, NULL, execucao_thread, e);
+    pthread_sigmask(SIG_SETMASK, &anteriores, NULL);
+    if (rc != 0) {
+        retirar_ativa(slot);
+        simulacao_destruir(e->sim);
+        return -1;
+    }
+    e->ocupada = 1;
+    return 0;
 }
 
-void init_resource(resource_t* res, int capacity, int is_torre) {
-    pthread_mutex_init(&res->mutex, NULL);
-    pthread_cond_init(&res->cond, NULL);
-    if (is_torre) pthread_cond_init(&res->cond_dom, NULL);
-    res->available = capacity;
-    res->waiting_dom = res->waiting_int = 0;
-    res->oldest_dom_time = 0;
+void finalizar_candidato(execucao_t* e, int slot, resultado_t* r) {
+    pthread_join(e->tid, NULL);
+    retirar_ativa(slot);
+    
+    if (r != NULL) {
+        simulacao_resultados_t res;
+        simulacao_resultados(e->sim, &res);
+        memset(r, 0, sizeof(*r));
+        r->pistas = res.pistas;
+        r->portoes = res.portoes;
+        r->torre = res.torre;
+        r->total = res.total;
+        r->sucessos = res.sucessos;
+        r->quedas = res.quedas;
+        r->alertas = res.alertas;
+        r->starvation = res.starvation;
+        r->espera_p50 = res.espera_p50;
+        r->espera_p95 = res.espera_p95;
+        r->espera_p99 = res.espera_p99;
+    }
+    simulacao_destruir(e->sim);
+    e->sim = NULL;
+    e->ocupada = 0;
 }
 
-int acquire_res(resource_t* res, int type, int timeout, int is_torre, int aviao_id, time_t tempo_inicio) {
-    struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
-    ts.tv_sec += timeout;
-    int alerta_enviado = 0;
-    time_t tempo_entrada_loop = time(NULL);
-    
-    pthread_mutex_lock(&res->mutex);
-    
-    if (type == VOO_DOMESTICO) {
-        res->waiting_dom++;
-        if (res->oldest_dom_time == 0) {
-            res->oldest_dom_time = time(NULL);
-        }
-    } else {
-        res->waiting_int++;
-    }
-    
-    int recurso_tipo = -1;
-    if (res == &pistas) recurso_tipo = 0;
-    else if (res == &portoes) recurso_tipo = 1;
-    else if (res == &torre) recurso_tipo = 2;
-    
-    int foi_adicionado_espera = 0;
-    
-    while (res->available <= 0 && simulation_running) {
-        if (!foi_adicionado_espera && recurso_tipo != -1) {
-            add_waiting_thread(aviao_id, recurso_tipo);
-            foi_adicionado_espera = 1;
-        }
-        
-        time_t agora = time(NULL);
-        time_t tempo_vida = agora - tempo_inicio;
-        time_t tempo_esperando = agora - tempo_entrada_loop;
-        
-        if (tempo_vida >= TIMEOUT_QUEDA) {
-            char msg[150];
-            snprintf(msg, sizeof(msg), "STARVATION: Aviao %d (%s) caiu - Tempo vida: %lds, Esperando: %lds", 
-                     aviao_id, type ? "INTL" : "DOM", tempo_vida, tempo_esperando);
-            log_msg(msg);
-            pthread_mutex_lock(&stats_mutex);
-            starvation_casos++;
-            pthread_mutex_unlock(&stats_mutex);
-            
-            if (type == VOO_DOMESTICO) {
-                res->waiting_dom--;
-                if (res->waiting_dom == 0) res->oldest_dom_time = 0;
-                remove_from_critical_list(aviao_id);
-            } else {
-                res->waiting_int--;
-            }
-            
-            if (foi_adicionado_espera) {
-                remove_waiting_thread(aviao_id);
-            }
-            
-            pthread_mutex_unlock(&res->mutex);
-            return -1;
-        }
-        
-        if (tempo_vida >= TEMPO_ALERTA && !alerta_enviado) {
-            char msg[150];
-            snprintf(msg, sizeof(msg), "ALERTA CRITICO: Aviao %d (%s) vida: %lds, esperando: %lds", 
-                     aviao_id, type ? "INTL" : "DOM", tempo_vida, tempo_esperando);
-            log_msg(msg);
-            pthread_mutex_lock(&stats_mutex);
-            alertas_criticos++;
-            pthread_mutex_unlock(&stats_mutex);
-            alerta_enviado = 1;
-            
-            if (type == VOO_DOMESTICO) {
-                add_to_critical_list(aviao_id, agora);
-            }
-        }
-        
-        struct timespec ts_curto;
-        clock_gettime(CLOCK_REALTIME, &ts_curto);
-        ts_curto.tv_sec += 1; 
-        
-        if (type == VOO_DOMESTICO && is_torre) {
-            if (pthread_cond_timedwait(&res->cond_dom, &res->mutex, &ts_curto) == ETIMEDOUT) {
-                continue;
-            }
-        } else {
-            if (pthread_cond_timedwait(&res->cond, &res->mutex, &ts_curto) == ETIMEDOUT) {
-                continue;
+int aguardar_execucao(execucao_t* execucoes, int n) {
+    pthread_mutex_lock(&execucoes_mutex);
+    for (;;) {
+        for (int k = 0; k < n; k++) {
+            if (execucoes[k].ocupada && execucoes[k].concluida) {
+                pthread_mutex_unlock(&execucoes_mutex);
+                return k;
             }
         }
+        pthread_cond_wait(&execucoes_cond, &execucoes_mutex);
     }
-    
-    if (!simulation_running || res->available <= 0) {
-        if (type == VOO_DOMESTICO) {
-            res->waiting_dom--;
-            if (res->waiting_dom == 0) res->oldest_dom_time = 0;
-            remove_from_critical_list(aviao_id);
-        } else {
-            res->waiting_int--;
-        }
-        
-        if (foi_adicionado_espera) {
-            remove_waiting_thread(aviao_id);
-        }
-        
-        pthread_mutex_unlock(&res->mutex);
-        return -1;
-    }
-    
-    if (type == VOO_DOMESTICO) {
-        res->waiting_dom--;
-        if (res->waiting_dom == 0) res->oldest_dom_time = 0;
-        remove_from_critical_list(aviao_id);
-    } else {
-        res->waiting_int--;
-    }
-    
-    if (foi_adicionado_espera) {
-        remove_waiting_thread(aviao_id);
-    }
-    if (recurso_tipo != -1) {
-        add_resource_holder(aviao_id, recurso_tipo);
-    }
-    
-    res->available--;
-    pthread_mutex_unlock(&res->mutex);
-    return 0;
 }
 
-void release_res(resource_t* res, int type, int is_torre, int aviao_id) {
-    pthread_mutex_lock(&res->mutex);
+double metrica_planejador(const resultado_t* r) {
+    if (r->total == 0) return 0;
     
-    int recurso_tipo = -1;
-    if (res == &pistas) recurso_tipo = 0;
-    else if (res == &portoes) recurso_tipo = 1;
-    else if (res == &torre) recurso_tipo = 2;
+    int valor;
+    if (strcmp(meta_metrica, "alertas") == 0) valor = r->alertas;
+    else if (strcmp(meta_metrica, "starvation") == 0) valor = r->starvation;
+    else valor = r->quedas;
     
-    if (recurso_tipo != -1) {
-        remove_resource_holder(aviao_id, recurso_tipo);
-    }
-    
-    res->available++;
-    
-    if (is_torre) {
-        if (res->waiting_int > 0) {
-            pthread_cond_signal(&res->cond); 
-        } else if (res->waiting_dom > 0) {
-            pthread_cond_signal(&res->cond_dom); 
-        } else {
-            pthread_cond_broadcast(&res->cond);
-            pthread_cond_broadcast(&res->cond_dom);
-        }
-    } else {
-        if (res->waiting_int > 0) {
-            pthread_cond_signal(&res->cond); 
-        } else {
-            pthread_cond_signal(&res->cond); 
+    return (double)valor / r->total * 100;
+}
+
+int buscar_avaliado(const int config[3]) {
+    for (int i = 0; i < num_avaliados; i++) {
+        if (avaliados[i].pistas == config[0] && avaliados[i].portoes == config[1] &&
+            avaliados[i].torre == config[2]) {
+            return i;
         }
     }
-    
-    pthread_mutex_unlock(&res->mutex);
+    return -1;
 }
 
-int acquire_with_backoff(resource_t* res1, resource_t* res2, int type, int is_torre1, int is_torre2, int aviao_id, time_t tempo_inicio) {
-    int max_tentativas = 20; 
-    int tentativa = 0;
-    
-    while (tentativa < max_tentativas && simulation_running) {
-        time_t tempo_vida = time(NULL) - tempo_inicio;
-        if (tempo_vida >= TIMEOUT_QUEDA) {
-            return -1; 
-        }
-        
-        if (acquire_res(res1, type, TIMEOUT_BACKOFF, is_torre1, aviao_id, tempo_inicio) != 0) {
-            usleep(500000 + rand() % 500000); 
-            tentativa++;
-            continue;
+int inferir_resultado(const int config[3]) {
+    for (int i = 0; i < num_avaliados; i++) {
+        const resultado_t* r = &avaliados[i];
+        if (r->ok && r->pistas <= config[0] && r->portoes <= config[1] && r->torre <= config[2]) {
+            return 1;
         }
-        
-        if (acquire_res(res2, type, TIMEOUT_BACKOFF, is_torre2, aviao_id, tempo_inicio) == 0) {
+        if (!r->ok && r->pistas >= config[0] && r->portoes >= config[1] && r->torre >= config[2]) {
             return 0;
         }
-        
-        release_res(res1, type, is_torre1, aviao_id);
-        
-        char msg[150];
-        snprintf(msg, sizeof(msg), "BACKOFF: Aviao %d (%s) liberou recursos para evitar deadlock (tentativa %d)", 
-                 aviao_id, type ? "INTL" : "DOM", tentativa + 1);
-        log_msg(msg);
-        
-        usleep(200000 + rand() % 300000); 
-        tentativa++;
-        
-        pthread_mutex_lock(&stats_mutex);
-        deadlocks_evitados++; 
-        pthread_mutex_unlock(&stats_mutex);
     }
-    
     return -1;
 }
 
-int acquire_three_resources(resource_t* res1, resource_t* res2, resource_t* res3, int type, int is_torre1, int is_torre2, int is_torre3, int aviao_id, time_t tempo_inicio) {
-    int max_tentativas = 20;
-    int tentativa = 0;
-    
-    while (tentativa < max_tentativas && simulation_running) {
-        time_t tempo_vida = time(NULL) - tempo_inicio;
-        if (tempo_vida >= TIMEOUT_QUEDA) {
-            return -1;
+// Retorna -1 se alguma candidata não pôde ser criada: o resultado dela é
+// desconhecido e não pode ser tratado como "não atende".
+int avaliar_candidatos(int candidatos[][3], int n, int* resultados) {
+    int pendentes[MAX_PARALELO];
+    execucao_t execucoes[MAX_PARALELO];
+    int num_pendentes = 0;
+    int falhou = 0;
+    
+    for (int i = 0; i < n; i++) {
+        int idx = buscar_avaliado(candidatos[i]);
+        if (idx != -1) {
+            resultados[i] = avaliados[idx].ok;
+            continue;
         }
         
-        if (acquire_res(res1, type, TIMEOUT_BACKOFF, is_torre1, aviao_id, tempo_inicio) != 0) {
-            usleep(500000 + rand() % 500000); 
-            tentativa++;
+        int inferido = inferir_resultado(candidatos[i]);
+        if (inferido != -1) {
+            resultados[i] = inferido;
             continue;
         }
         
-        if (acquire_res(res2, type, TIMEOUT_BACKOFF, is_torre2, aviao_id, tempo_inicio) != 0) {
-            release_res(res1, type, is_torre1, aviao_id);
-            char msg[150];
-            snprintf(msg, sizeof(msg), "BACKOFF: Aviao %d (%s) liberou recurso 1 (decolagem tentativa %d)", 
-                     aviao_id, type ? "INTL" : "DOM", tentativa + 1);
-            log_msg(msg);
-            usleep(200000 + rand() % 300000); 
-            tentativa++;
+        resultados[i] = -1;
+        if (interrompido || limite_atingido || falhou) continue;
+        if (num_avaliados + num_pendentes >= MAX_AVALIADOS) {
+            printf("ERRO: Limite de avaliacoes atingido (%d simulacoes), busca interrompida\n", MAX_AVALIADOS);
+            limite_atingido = 1;
             continue;
         }
-        
-        if (acquire_res(res3, type, TIMEOUT_BACKOFF, is_torre3, aviao_id, tempo_inicio) == 0) {
-            return 0;
+        if (iniciar_candidato(&execucoes[num_pendentes], num_pendentes, candidatos[i], simulacao_config(modelo)->semente) != 0) {
+            printf("ERRO: Falha ao iniciar simulacao candidata (Pistas=%d, Portoes=%d, Torre=%d)\n",
+                   candidatos[i][0], candidatos[i][1], candidatos[i][2]);
+            falhou = 1;
+            continue;
         }
-        
-        release_res(res2, type, is_torre2, aviao_id);
-        release_res(res1, type, is_torre1, aviao_id);
-        
-        char msg[150];
-        snprintf(msg, sizeof(msg), "BACKOFF: Aviao %d (%s) liberou recursos 1+2 (decolagem tentativa %d)", 
-                 aviao_id, type ? "INTL" : "DOM", tentativa + 1);
-        log_msg(msg);
-        
-        usleep(200000 + rand() % 300000); 
-        tentativa++;
-        
-        pthread_mutex_lock(&stats_mutex);
-        deadlocks_evitados++; 
-        pthread_mutex_unlock(&stats_mutex);
-    }
-    
-    return -1;
-}
-
-
-
-
-
-void* airplane_thread(void* arg) {
-    airplane_t* plane = (airplane_t*)arg;
-    char msg[100];
-    
-    pthread_mutex_lock(&avioes_mutex);
-    plane->tempo_inicio = time(NULL);
-    plane->estado = 0;
-    pthread_mutex_unlock(&avioes_mutex);
-    
-    pthread_mutex_lock(&stats_mutex);
-    ativos++;
-    pthread_mutex_unlock(&stats_mutex);
-    
-    snprintf(msg, sizeof(msg), "Aviao %d (%s): Iniciando", 
-             plane->id, plane->type ? "INTL" : "DOM");
-    log_msg(msg);
-    
-    pthread_mutex_lock(&avioes_mutex);
-    plane->estado = 0;
-    pthread_mutex_unlock(&avioes_mutex);
-    int pouso_result;
-    if (plane->type == VOO_INTERNACIONAL) {
-        pouso_result = acquire_with_backoff(&pistas, &torre, plane->type, 0, 1, plane->id, plane->tempo_inicio);
-    } else {
-        pouso_result = acquire_with_backoff(&torre, &pistas, plane->type, 1, 0, plane->id, plane->tempo_inicio);
+        pendentes[num_pendentes++] = i;
     }
     
-    if (pouso_result == 0) {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "Aviao %d: POUSANDO", plane->id);
-        log_msg(msg);
-        sleep(TEMPO_POUSO_MIN + rand() % TEMPO_POUSO_VAR);
+    for (int k = 0; k < num_pendentes; k++) {
+        int i = pendentes[k];
+        resultado_t r;
+        finalizar_candidato(&execucoes[k], k, &r);
+        // Uma candidata encerrada por Ctrl+C não simulou o tempo todo.
+        if (interrompido) continue;
         
-        release_res(&pistas, plane->type, 0, plane->id);
-        release_res(&torre, plane->type, 1, plane->id);
-    }
-    
-    if (pouso_result != 0) {
-        pthread_mutex_lock(&avioes_mutex);
-        plane->estado = -1;
-        pthread_mutex_unlock(&avioes_mutex);
-        time_t tempo_total = time(NULL) - plane->tempo_inicio;
-        snprintf(msg, sizeof(msg), "Aviao %d: QUEDA (tempo total: %lds)", plane->id, tempo_total);
-        log_msg(msg);
-        update_stats(-1, plane->type);
-        pthread_mutex_lock(&stats_mutex);
-        ativos--;
-        pthread_mutex_unlock(&stats_mutex);
-        return NULL;
-    }
-    
-    pthread_mutex_lock(&avioes_mutex);
-    plane->estado = 1;
-    pthread_mutex_unlock(&avioes_mutex);
-    int desembarque_result;
-    if (plane->type == VOO_INTERNACIONAL) {
-        desembarque_result = acquire_with_backoff(&portoes, &torre, plane->type, 0, 1, plane->id, plane->tempo_inicio);
-    } else {
-        desembarque_result = acquire_with_backoff(&torre, &portoes, plane->type, 1, 0, plane->id, plane->tempo_inicio);
-    }
-    
-    if (desembarque_result == 0) {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "Aviao %d: DESEMBARCANDO", plane->id);
-        log_msg(msg);
-        sleep(TEMPO_DESEMB_MIN + rand() % TEMPO_DESEMB_VAR);
-        release_res(&torre, plane->type, 1, plane->id);
-        sleep(1);
-        release_res(&portoes, plane->type, 0, plane->id);
-    }
-    
-    if (desembarque_result != 0) {
-        pthread_mutex_lock(&avioes_mutex);
-        plane->estado = -1;
-        pthread_mutex_unlock(&avioes_mutex);
-        time_t tempo_total = time(NULL) - plane->tempo_inicio;
-        snprintf(msg, sizeof(msg), "Aviao %d: QUEDA (tempo total: %lds)", plane->id, tempo_total);
-        log_msg(msg);
-        update_stats(-1, plane->type);
-        pthread_mutex_lock(&stats_mutex);
-        ativos--;
-        pthread_mutex_unlock(&stats_mutex);
-        return NULL;
-    }
-    
-    pthread_mutex_lock(&avioes_mutex);
-    plane->estado = 2;
-    pthread_mutex_unlock(&avioes_mutex);
-    int decolagem_result;
-    if (plane->type == VOO_INTERNACIONAL) {
-        decolagem_result = acquire_three_resources(&portoes, &pistas, &torre, plane->type, 0, 0, 1, plane->id, plane->tempo_inicio);
-    } else {
-        decolagem_result = acquire_three_resources(&torre, &portoes, &pistas, plane->type, 1, 0, 0, plane->id, plane->tempo_inicio);
-    }
-    
-    if (decolagem_result == 0) {
-        char msg[100];
-        snprintf(msg, sizeof(msg), "Aviao %d: DECOLANDO", plane->id);
-        log_msg(msg);
-        sleep(TEMPO_DECOL_MIN + rand() % TEMPO_DECOL_VAR);
+        double valor = metrica_planejador(&r);
+        r.ok = valor <= meta_limite;
+        avaliados[num_avaliados++] = r;
+        resultados[i] = r.ok;
         
-        release_res(&pistas, plane->type, 0, plane->id);
-        release_res(&torre, plane->type, 1, plane->id);
-        release_res(&portoes, plane->type, 0, plane->id);
-    }
-    
-    if (decolagem_result != 0) {
-        pthread_mutex_lock(&avioes_mutex);
-        plane->estado = -1;
-        pthread_mutex_unlock(&avioes_mutex);
-        time_t tempo_total = time(NULL) - plane->tempo_inicio;
-        snprintf(msg, sizeof(msg), "Aviao %d: QUEDA (tempo total: %lds)", plane->id, tempo_total);
-        log_msg(msg);
-        update_stats(-1, plane->type);
-        pthread_mutex_lock(&stats_mutex);
-        ativos--;
-        pthread_mutex_unlock(&stats_mutex);
-        return NULL;
-    }
-    
-    pthread_mutex_lock(&avioes_mutex);
-    plane->estado = 3;
-    pthread_mutex_unlock(&avioes_mutex);
-    time_t tempo_total = time(NULL) - plane->tempo_inicio;
-    snprintf(msg, sizeof(msg), "Aviao %d: SUCESSO (tempo total: %lds)", plane->id, tempo_total);
-    log_msg(msg);
-    update_stats(1, plane->type);
-    
-    pthread_mutex_lock(&stats_mutex);
-    ativos--;
-    pthread_mutex_unlock(&stats_mutex);
-    return NULL;
-}
-
-void* monitor_thread(void* arg __attribute__((unused))) {
-    while (simulation_running) {
-        sleep(15);
-        
-        pthread_mutex_lock(&stats_mutex);
-        printf("\n*** STATUS ***\n");
-        printf("Total: %d | Ativos: %d | Sucessos: %d | Quedas: %d\n", 
-               total_avioes, ativos, sucessos, quedas);
-        printf("Domesticos: %d | Internacionais: %d\n", domesticos, internacionais);
-        printf("Alertas: %d | Starvation: %d | DL Det: %d | DL Res: %d | DL Evit: %d | Preempções: %d\n", 
-               alertas_criticos, starvation_casos, deadlocks_detectados, deadlocks_resolvidos, deadlocks_evitados, preempcoes_realizadas);
-        
-        int elapsed = time(NULL) - start_time;
-        int remaining = tempo_sim - elapsed;
-        printf("Tempo restante: %02d:%02d\n", remaining / 60, remaining % 60);
-        printf("==================================\n");
+        printf("CANDIDATO: Pistas=%d, Portoes=%d, Torre=%d | Avioes=%d | %s=%.2f%% | %s\n",
+               r.pistas, r.portoes, r.torre, r.total, meta_metrica, valor,
+               r.ok ? "ATENDE" : "NAO ATENDE");
         fflush(stdout);
-        pthread_mutex_unlock(&stats_mutex);
     }
-    return NULL;
+    return falhou ? -1 : 0;
 }
 
-void update_stats(int status, int type) {
-    pthread_mutex_lock(&stats_mutex);
-    total_avioes++;
-    if (type == VOO_DOMESTICO) domesticos++;
-    else internacionais++;
-    if (status == 1) sucessos++;
-    else if (status == -1) quedas++;
-    pthread_mutex_unlock(&stats_mutex);
-}
-
-void add_to_critical_list(int aviao_id, time_t tempo_critico) {
-    pthread_mutex_lock(&critical_mutex);
-    
-    critical_airplane_t* new_critical = malloc(sizeof(critical_airplane_t));
-    new_critical->aviao_id = aviao_id;
-    new_critical->tempo_critico = tempo_critico;
-    new_critical->next = critical_list;
-    critical_list = new_critical;
+int reduzir_dimensao(int config[3], int dim) {
+    int lo = 1, hi = config[dim];
     
-    char msg[150];
-    snprintf(msg, sizeof(msg), "AGING: Aviao %d adicionado à lista crítica", aviao_id);
-    log_msg(msg);
-    
-    pthread_mutex_unlock(&critical_mutex);
-}
-
-void remove_from_critical_list(int aviao_id) {
-    pthread_mutex_lock(&critical_mutex);
-    
-    critical_airplane_t* current = critical_list;
-    critical_airplane_t* prev = NULL;
-    
-    while (current != NULL) {
-        if (current->aviao_id == aviao_id) {
-            if (prev == NULL) {
-                critical_list = current->next;
-            } else {
-                prev->next = current->next;
+    while (lo < hi) {
+        int n = hi - lo;
+        if (n > paralelo) n = paralelo;
+        
+        int candidatos[MAX_PARALELO][3];
+        int resultados[MAX_PARALELO];
+        for (int k = 0; k < n; k++) {
+            memcpy(candidatos[k], config, sizeof(candidatos[k]));
+            candidatos[k][dim] = lo + (int)((long)(hi - lo) * k / n);
+        }
+        
+        if (avaliar_candidatos(candidatos, n, resultados) != 0) return -1;
+        // Candidatas não avaliadas não dizem nada sobre a meta: config[dim]
+        // fica no último valor que a atendeu.
+        if (interrompido || limite_atingido) return 0;
+        
+        int novo_hi = hi, novo_lo = lo;
+        for (int k = 0; k < n; k++) {
+            if (resultados[k] == 1 && candidatos[k][dim] < novo_hi) {
+                novo_hi = candidatos[k][dim];
             }
-            free(current);
-            break;
         }
-        prev = current;
-        current = current->next;
-    }
-    
-    pthread_mutex_unlock(&critical_mutex);
-}
-
-int check_preemption_needed() {
-    pthread_mutex_lock(&critical_mutex);
-    
-    critical_airplane_t* current = critical_list;
-    time_t now = time(NULL);
-    
-    while (current != NULL) {
-        if (now - current->tempo_critico >= 2) { 
-            int victim_id = current->aviao_id;
-            pthread_mutex_unlock(&critical_mutex);
-            return victim_id;
+        for (int k = 0; k < n; k++) {
+            if (resultados[k] != 1 && candidatos[k][dim] < novo_hi && candidatos[k][dim] + 1 > novo_lo) {
+                novo_lo = candidatos[k][dim] + 1;
+            }
         }
-        current = current->next;
+        lo = novo_lo;
+        hi = novo_hi;
     }
     
-    pthread_mutex_unlock(&critical_mutex);
-    return -1;
+    config[dim] = hi;
+    return 0;
 }
 
-int force_preemption(int critical_aviao_id) {
-    pthread_mutex_lock(&avioes_mutex);
-    
-    for (int i = 0; i < airplane_counter; i++) {
-        if (avioes[i].type == VOO_INTERNACIONAL && 
-            (avioes[i].estado == 0 || avioes[i].estado == 1 || avioes[i].estado == 2 || avioes[i].estado == 3)) {
-            
-            char msg[200];
-            snprintf(msg, sizeof(msg), "PREEMPCAO: Aviao %d (DOM crítico) forçou liberação do aviao %d (INTL)", 
-                     critical_aviao_id, avioes[i].id);
-            log_msg(msg);
-            
-            avioes[i].tempo_inicio = time(NULL); 
-            avioes[i].estado = 0; 
-            
-            int victim_id = avioes[i].id;
-            
-            pthread_mutex_unlock(&avioes_mutex); 
-            
-            pthread_mutex_lock(&stats_mutex);
-            preempcoes_realizadas++;
-            pthread_mutex_unlock(&stats_mutex);
-            
-            release_res(&torre, VOO_INTERNACIONAL, 1, victim_id);
-            release_res(&pistas, VOO_INTERNACIONAL, 0, victim_id);
-            release_res(&portoes, VOO_INTERNACIONAL, 0, victim_id);
-            
-            return victim_id;
+int planejar_capacidade() {
+    const int ordens[6][3] = {{0,1,2},{0,2,1},{1,0,2},{1,2,0},{2,0,1},{2,1,0}};
+    int maximo[3] = {max_pistas, max_portoes, max_torre};
+    const simulacao_config_t* cfg = simulacao_config(modelo);
+    
+    printf("=== PLANEJADOR DE CAPACIDADE ===\n");
+    printf("META: %s <= %.2f%% | Limites: Pistas<=%d, Portoes<=%d, Torre<=%d | Intervalo=%d-%dms | Tempo=%ds | Paralelo=%d\n",
+           meta_metrica, meta_limite, max_pistas, max_portoes, max_torre,
+           cfg->intervalo_min, cfg->intervalo_max, cfg->tempo, paralelo);
+    
+    int resultado_max;
+    if (avaliar_candidatos(&maximo, 1, &resultado_max) != 0) {
+        printf("\nRESULTADO: Busca abortada, nao foi possivel executar a configuracao maxima\n");
+        return 1;
+    }
+    if (resultado_max == -1) {
+        printf("\nRESULTADO: Busca interrompida antes de avaliar a configuracao maxima\n");
+        return 1;
+    }
+    if (resultado_max != 1) {
+        printf("\nRESULTADO: Nenhuma configuracao dentro dos limites atende a meta\n");
+        return 1;
+    }
+    
+    int melhor[3] = {max_pistas, max_portoes, max_torre};
+    int melhor_custo = -1;
+    
+    for (int o = 0; o < 6; o++) {
+        int config[3] = {max_pistas, max_portoes, max_torre};
+        int mudou = 1;
+        while (mudou && !interrompido && !limite_atingido) {
+            int anterior[3];
+            memcpy(anterior, config, sizeof(anterior));
+            for (int d = 0; d < 3; d++) {
+                if (reduzir_dimensao(config, ordens[o][d]) != 0) {
+                    printf("\nRESULTADO: Busca abortada, nao foi possivel executar uma simulacao candidata\n");
+                    return 1;
+                }
+            }
+            mudou = memcmp(anterior, config, sizeof(anterior)) != 0;
         }
-    }
-    
-    pthread_mutex_unlock(&avioes_mutex);
-    return -1;
-}
-
-int force_preemption_by_id(int victim_id) {
-    pthread_mutex_lock(&avioes_mutex);
-    
-    for (int i = 0; i < airplane_counter; i++) {
-        if (avioes[i].id == victim_id &&
-            (avioes[i].estado == 0 || avioes[i].estado == 1 || avioes[i].estado == 2)) {
-            
-            char msg[200];
-            snprintf(msg, sizeof(msg), "RESOLUCAO DEADLOCK: Aviao %d (%s) forçado a liberar recursos", 
-                     victim_id, avioes[i].type ? "INTL" : "DOM");
-            log_msg(msg);
-            
-            avioes[i].tempo_inicio = time(NULL); 
-            avioes[i].estado = 0; 
-            
-            release_res(&torre, avioes[i].type, 1, avioes[i].id);
-            release_res(&pistas, avioes[i].type, 0, avioes[i].id);
-            release_res(&portoes, avioes[i].type, 0, avioes[i].id);
-            
-            pthread_mutex_unlock(&avioes_mutex);
-            return victim_id;
+        
+        int custo = config[0] * custo_recurso[0] + config[1] * custo_recurso[1] + config[2] * custo_recurso[2];
+        if (melhor_custo == -1 || custo < melhor_custo) {
+            melhor_custo = custo;
+            memcpy(melhor, config, sizeof(melhor));
         }
+        if (interrompido || limite_atingido) break;
     }
     
-    pthread_mutex_unlock(&avioes_mutex);
-    return -1;
-}
-
-int resolve_deadlock(int aviao1_id, int aviao2_id) {  
-    airplane_t* aviao1 = NULL;
-    airplane_t* aviao2 = NULL;
-    
-    for (int i = 0; i < airplane_counter; i++) {
-        if (avioes[i].id == aviao1_id) aviao1 = &avioes[i];
-        if (avioes[i].id == aviao2_id) aviao2 = &avioes[i];
-    }
-    
-    if (aviao1 == NULL || aviao2 == NULL) return -1;
-    
-
-    airplane_t* victim;
-    if (aviao1->tempo_inicio > aviao2->tempo_inicio) {
-        victim = aviao1;
-    } else if (aviao2->tempo_inicio > aviao1->tempo_inicio) {
-        victim = aviao2;
-    } else {
-        victim = (aviao1->type == VOO_DOMESTICO) ? aviao1 : aviao2;
-    }
-    
-    char msg[200];
-    snprintf(msg, sizeof(msg), "ESCOLHA VITIMA: Aviao %d (%s, idade: %lds) escolhido como vítima entre %d e %d",
-             victim->id, victim->type ? "INTL" : "DOM", 
-             time(NULL) - victim->tempo_inicio, aviao1_id, aviao2_id);
-    log_msg(msg);
-    
-    int result = force_preemption_by_id(victim->id);
-    
-    if (result != -1) {
-        pthread_mutex_lock(&stats_mutex);
-        deadlocks_resolvidos++;
-        pthread_mutex_unlock(&stats_mutex);
-    }
-    
-    return result;
-}
-
-void* aging_thread(void* arg __attribute__((unused))) {
-    while (simulation_running) {
-        sleep(5); 
-        
-        int critical_id = check_preemption_needed();
-        if (critical_id != -1) {
-            force_preemption(critical_id);
-            remove_from_critical_list(critical_id);
-        }
+    printf("\n==================================================================\n");
+    printf("                 RESULTADO DO PLANEJADOR                          \n");
+    printf("==================================================================\n");
+    if (interrompido || limite_atingido) {
+        printf("Busca incompleta (%s): a configuracao abaixo atende a meta, mas pode nao ser a mais barata\n",
+               interrompido ? "interrompida" : "limite de avaliacoes atingido");
+    }
+    printf("Configuracao mais barata: Pistas=%d, Portoes=%d, Torre=%d (custo %d)\n",
+           melhor[0], melhor[1], melhor[2], melhor_custo);
+    printf("Simulacoes executadas: %d\n", num_avaliados);
+    printf("\nEVIDENCIAS:\n");
+    for (int i = 0; i < num_avaliados; i++) {
+        const resultado_t* r = &avaliados[i];
+        printf("Pistas=%d, Portoes=%d, Torre=%d | Avioes=%d | Sucessos=%d | Quedas=%d | %s=%.2f%% | %s%s\n",
+               r->pistas, r->portoes, r->torre, r->total, r->sucessos, r->quedas,
+               meta_metrica, metrica_planejador(r), r->ok ? "ATENDE" : "NAO ATENDE",
+               (r->pistas == melhor[0] && r->portoes == melhor[1] && r->torre == melhor[2]) ? " <== ESCOLHIDA" : "");
     }
-    return NULL;
+    printf("==================================================================\n");
+    return 0;
 }
 
-void add_resource_holder(int aviao_id, int recurso_tipo) {
-    pthread_mutex_lock(&deadlock_mutex);
-    
-    resource_holder_t* new_holder = malloc(sizeof(resource_holder_t));
-    new_holder->aviao_id = aviao_id;
-    new_holder->recurso_tipo = recurso_tipo;
-    
-    if (recurso_tipo == 0) { 
-        new_holder->next = pistas_holders;
-        pistas_holders = new_holder;
-    } else if (recurso_tipo == 1) { 
-        new_holder->next = portoes_holders;
-        portoes_holders = new_holder;
-    } else if (recurso_tipo == 2) { 
-        new_holder->next = torre_holders;
-        torre_holders = new_holder;
-    }
-    
-    pthread_mutex_unlock(&deadlock_mutex);
+double t_critico_95(int graus_liberdade) {
+    static const double tabela[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    if (graus_liberdade < 1) return 0;
+    if (graus_liberdade <= 30) return tabela[graus_liberdade - 1];
+    if (graus_liberdade <= 60) return 2.000;
+    if (graus_liberdade <= 120) return 1.980;
+    return 1.960;
 }
 
-void remove_resource_holder(int aviao_id, int recurso_tipo) {
-    pthread_mutex_lock(&deadlock_mutex);
+// Média e semiamplitude do intervalo de confiança de 95% (t de Student).
+void intervalo_confianca(const double* valores, int n, double* media, double* semiamplitude) {
+    double soma = 0;
+    for (int i = 0; i < n; i++) soma += valores[i];
+    *media = n > 0 ? soma / n : 0;
     
-    resource_holder_t** list_head;
-    if (recurso_tipo == 0) list_head = &pistas_holders;
-    else if (recurso_tipo == 1) list_head = &portoes_holders;
-    else if (recurso_tipo == 2) list_head = &torre_holders;
-    else {
-        pthread_mutex_unlock(&deadlock_mutex);
+    if (n < 2) {
+        *semiamplitude = 0;
         return;
     }
-    
-    resource_holder_t* current = *list_head;
-    resource_holder_t* prev = NULL;
-    
-    while (current != NULL) {
-        if (current->aviao_id == aviao_id) {
-            if (prev == NULL) {
-                *list_head = current->next;
-            } else {
-                prev->next = current->next;
-            }
-            free(current);
-            break;
-        }
-        prev = current;
-        current = current->next;
+    double soma_quadrados = 0;
+    for (int i = 0; i < n; i++) {
+        soma_quadrados += (valores[i] - *media) * (valores[i] - *media);
     }
-    
-    pthread_mutex_unlock(&deadlock_mutex);
-}
-
-void add_waiting_thread(int aviao_id, int recurso_tipo) {
-    pthread_mutex_lock(&deadlock_mutex);
-    
-    waiting_thread_t* new_waiting = malloc(sizeof(waiting_thread_t));
-    new_waiting->aviao_id = aviao_id;
-    new_waiting->recurso_tipo = recurso_tipo;
-    new_waiting->tempo_espera = time(NULL);
-    new_waiting->next = waiting_threads;
-    waiting_threads = new_waiting;
-    
-    pthread_mutex_unlock(&deadlock_mutex);
+    double desvio = sqrt(soma_quadrados / (n - 1));
+    *semiamplitude = t_critico_95(n - 1) * desvio / sqrt(n);
 }
 
-void remove_waiting_thread(int aviao_id) {
-    pthread_mutex_lock(&deadlock_mutex);
-    
-    waiting_thread_t* current = waiting_threads;
-    waiting_thread_t* prev = NULL;
+int replicar_simulacao() {
+    static double taxa_sucesso[MAX_REPLICACOES], taxa_queda[MAX_REPLICACOES];
+    static double p50[MAX_REPLICACOES], p95[MAX_REPLICACOES], p99[MAX_REPLICACOES];
+    execucao_t execucoes[MAX_PARALELO];
+    int em_execucao = 0, iniciadas = 0, concluidas = 0, falhas = 0, descartadas = 0;
+    int convergiu = 0;
+    const simulacao_config_t* cfg = simulacao_config(modelo);
+    int config[3] = {cfg->pistas, cfg->portoes, cfg->torre};
+    double media, semi_sucesso = 0, semi_queda = 0;
+    
+    memset(execucoes, 0, sizeof(execucoes));
+    
+    printf("=== REPLICACOES INDEPENDENTES ===\n");
+    printf("CONFIGURACAO: Pistas=%d, Portoes=%d, Torre=%d | Intervalo=%d-%dms | Tempo=%ds\n",
+           cfg->pistas, cfg->portoes, cfg->torre, cfg->intervalo_min, cfg->intervalo_max, cfg->tempo);
+    printf("META: largura do IC 95%% de sucessos e quedas < %.2f p.p. | Max=%d | Paralelo=%d | Semente base=%u\n",
+           precisao_replicacao, max_replicacoes, paralelo, cfg->semente);
+    fflush(stdout);
     
-    while (current != NULL) {
-        if (current->aviao_id == aviao_id) {
-            if (prev == NULL) {
-                waiting_threads = current->next;
-            } else {
-                prev->next = current->next;
+    while (em_execucao > 0 || (!convergiu && !interrompido && iniciadas < max_replicacoes)) {
+        while (!convergiu && !interrompido && em_execucao < paralelo && iniciadas < max_replicacoes) {
+            int k = 0;
+            while (execucoes[k].ocupada) k++;
+            unsigned semente_replicacao = cfg->semente + iniciadas;
+            iniciadas++;
+            if (iniciar_candidato(&execucoes[k], k, config, semente_replicacao) != 0) {
+                printf("ERRO: Falha ao iniciar replicacao\n");
+                falhas++;
+                continue;
             }
-            free(current);
-            break;
+            em_execucao++;
         }
-        prev = current;
-        current = current->next;
-    }
-    
-    pthread_mutex_unlock(&deadlock_mutex);
-}
-
-int detect_deadlock() {
-    pthread_mutex_lock(&deadlock_mutex);
-    
-    waiting_thread_t* waiter = waiting_threads;
-    
-    while (waiter != NULL) {
-        resource_holder_t* holders;
+        if (em_execucao == 0) break;
         
-        if (waiter->recurso_tipo == 0) holders = pistas_holders;
-        else if (waiter->recurso_tipo == 1) holders = portoes_holders;
-        else if (waiter->recurso_tipo == 2) holders = torre_holders;
-        else {
-            waiter = waiter->next;
+        int k = aguardar_execucao(execucoes, paralelo);
+        unsigned semente_replicacao = execucoes[k].semente;
+        resultado_t r;
+        finalizar_candidato(&execucoes[k], k, &r);
+        em_execucao--;
+        // Uma replicação encerrada por Ctrl+C não simulou o tempo todo e
+        // distorceria a média e os intervalos.
+        if (interrompido) {
+            descartadas++;
             continue;
         }
         
-        resource_holder_t* holder = holders;
-        while (holder != NULL) {
-            waiting_thread_t* holder_waiting = waiting_threads;
-            while (holder_waiting != NULL) {
-                if (holder_waiting->aviao_id == holder->aviao_id) {
-                    resource_holder_t* waiter_resources[3] = {pistas_holders, portoes_holders, torre_holders};
-                    
-                    for (int i = 0; i < 3; i++) {
-                        resource_holder_t* wr = waiter_resources[i];
-                        while (wr != NULL) {
-                            if (wr->aviao_id == waiter->aviao_id && i == holder_waiting->recurso_tipo) {
-                                char msg[200];
-                                snprintf(msg, sizeof(msg), 
-                                    "DEADLOCK DETECTADO: Aviao %d espera recurso %d (ocupado por %d), Aviao %d espera recurso %d (ocupado por %d)",
-                                    waiter->aviao_id, waiter->recurso_tipo, holder->aviao_id,
-                                    holder->aviao_id, holder_waiting->recurso_tipo, waiter->aviao_id);
-                                log_msg(msg);
-                                
-                                pthread_mutex_lock(&stats_mutex);
-                                deadlocks_detectados++;
-                                pthread_mutex_unlock(&stats_mutex);
-                                
-                                pthread_mutex_unlock(&deadlock_mutex);
-                                
-                                resolve_deadlock(waiter->aviao_id, holder->aviao_id);
-                                
-                                return 1; 
-                            }
-                            wr = wr->next;
-                        }
-                    }
-                    break;
-                }
-                holder_waiting = holder_waiting->next;
+        int n = concluidas++;
+        taxa_sucesso[n] = r.total > 0 ? (double)r.sucessos / r.total * 100 : 0;
+        taxa_queda[n] = r.total > 0 ? (double)r.quedas / r.total * 100 : 0;
+        p50[n] = r.espera_p50;
+        p95[n] = r.espera_p95;
+        p99[n] = r.espera_p99;
+        
+        intervalo_confianca(taxa_sucesso, concluidas, &media, &semi_sucesso);
+        intervalo_confianca(taxa_queda, concluidas, &media, &semi_queda);
+        printf("REPLICACAO %d: semente=%u | Avioes=%d | Sucessos=%.1f%% | Quedas=%.1f%% | Espera p50/p95/p99=%lld/%lld/%lldms | IC sucessos +-%.2f, quedas +-%.2f\n",
+               concluidas, semente_replicacao, r.total, taxa_sucesso[n], taxa_queda[n],
+               r.espera_p50, r.espera_p95, r.espera_p99, semi_sucesso, semi_queda);
+        fflush(stdout);
+        
+        if (!convergiu && concluidas >= MIN_REPLICACOES &&
+            2 * semi_sucesso < precisao_replicacao && 2 * semi_queda < precisao_replicacao) {
+            convergiu = 1;
+            for (int j = 0; j < paralelo; j++) {
+                if (execucoes[j].ocupada) simulacao_encerrar(execucoes[j].sim);
+            }
+            for (int j = 0; j < paralelo; j++) {
+                if (execucoes[j].ocupada) finalizar_candidato(&execucoes[j], j, NULL);
             }
-            holder = holder->next;
+            em_execucao = 0;
         }
-        waiter = waiter->next;
     }
     
-    pthread_mutex_unlock(&deadlock_mutex);
-    return 0; 
-}
-
-void* deadlock_detection_thread(void* arg __attribute__((unused))) {
-    while (simulation_running) {
-        sleep(3); 
-        detect_deadlock();
+    printf("\n==================================================================\n");
+    printf("                 RESULTADO DAS REPLICACOES                        \n");
+    printf("==================================================================\n");
+    printf("Replicacoes concluidas: %d (iniciadas: %d, falhas: %d, descartadas por interrupcao: %d)\n",
+           concluidas, iniciadas, falhas, descartadas);
+    printf("Criterio de parada: %s\n", convergiu ? "precisao atingida" : interrompido ? "interrompido" : "limite de replicacoes");
+    if (concluidas == 0) {
+        printf("==================================================================\n");
+        return 1;
+    }
+    
+    printf("\n%-22s %12s %14s\n", "METRICA", "MEDIA", "IC 95%");
+    const char* nomes[5] = {"Sucessos (%)", "Quedas (%)", "Espera p50 (ms)", "Espera p95 (ms)", "Espera p99 (ms)"};
+    double* series[5] = {taxa_sucesso, taxa_queda, p50, p95, p99};
+    for (int m = 0; m < 5; m++) {
+        double semi;
+        intervalo_confianca(series[m], concluidas, &media, &semi);
+        printf("%-22s %12.2f %8s%.2f  [%.2f, %.2f]\n", nomes[m], media, "+-", semi, media - semi, media + semi);
     }
-    return NULL;
-}
-
-void signal_handler(int sig __attribute__((unused))) {
-    simulation_running = 0;
+    printf("==================================================================\n");
+    return convergiu ? 0 : 1;
 }
 
 int main(int argc, char *argv[]) {
-    srand(time(NULL));
+    modelo = simulacao_criar(NULL);
+    if (modelo == NULL) {
+        printf("ERRO: Memoria insuficiente\n");
+        exit(1);
+    }
+    simulacao_config_t* cfg = simulacao_config(modelo);
+    cfg->semente = (unsigned)time(NULL);
+    cfg->saida = stdout;
     signal(SIGINT, signal_handler);
+    signal(SIGUSR1, checkpoint_handler);
     
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--pistas") == 0 && i + 1 < argc) {
-            num_pistas = atoi(argv[++i]);
+            cfg->pistas = atoi(argv[++i]);
         } else if (strcmp(argv[i], "--portoes") == 0 && i + 1 < argc) {
-            num_portoes = atoi(argv[++i]);
+            cfg->portoes = atoi(argv[++i]);
         } else if (strcmp(argv[i], "--torre") == 0 && i + 1 < argc) {
-            capacidade_torre = atoi(argv[++i]);
+            cfg->torre = atoi(argv[++i]);
         } else if (strcmp(argv[i], "--tempo") == 0 && i + 1 < argc) {
-            tempo_sim = atoi(argv[++i]);
+            cfg->tempo = atoi(argv[++i]);
         } else if (strcmp(argv[i], "--intervalo-min") == 0 && i + 1 < argc) {
-            intervalo_min = atoi(argv[++i]);
+            cfg->intervalo_min = atoi(argv[++i]);
         } else if (strcmp(argv[i], "--intervalo-max") == 0 && i + 1 < argc) {
-            intervalo_max = atoi(argv[++i]);
+            cfg->intervalo_max = atoi(argv[++i]);
         } else if (strcmp(argv[i], "--intervalo") == 0 && i + 2 < argc) {
-            intervalo_min = atoi(argv[++i]);
-            intervalo_max = atoi(argv[++i]);
+            cfg->intervalo_min = atoi(argv[++i]);
+            cfg->intervalo_max = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--recurso") == 0 && i + 2 < argc) {
+            const char* nome = argv[++i];
+            if (simulacao_declarar_recurso(modelo, nome, atoi(argv[++i])) < 0) exit(1);
+        } else if (strcmp(argv[i], "--fase") == 0 && i + 3 < argc) {
+            const char* fase = argv[++i];
+            const char* tipo = argv[++i];
+            if (simulacao_definir_fase(modelo, fase, tipo, argv[++i]) != 0) exit(1);
+        } else if (strcmp(argv[i], "--servico") == 0 && i + 3 < argc) {
+            const char* fase = argv[++i];
+            const char* tipo = argv[++i];
+            if (simulacao_definir_servico(modelo, fase, tipo, argv[++i]) != 0) exit(1);
+        } else if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            if (simulacao_carregar_configuracao(modelo, argv[++i]) != 0) exit(1);
+        } else if (strcmp(argv[i], "--politica") == 0 && i + 1 < argc) {
+            if (simulacao_definir_politica(modelo, argv[++i]) != 0) {
+                printf("ERRO: Politica desconhecida '%s' (use fifo, prioridade, edf ou wfq)\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--max-ativos") == 0 && i + 1 < argc) {
+            cfg->max_ativos = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fila-espera") == 0 && i + 1 < argc) {
+            cfg->fila_espera = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--espera-max") == 0 && i + 1 < argc) {
+            cfg->espera_max = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fila-pouso") == 0 && i + 1 < argc) {
+            cfg->fila_pouso = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--perfil-locks") == 0) {
+            cfg->perfil_locks = 1;
+        } else if (strcmp(argv[i], "--drenagem") == 0 && i + 1 < argc) {
+            cfg->drenagem = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            cfg->semente = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--exportar") == 0 && i + 1 < argc) {
+            prefixo_exportacao = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            cfg->trace = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            cfg->checkpoint = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint-intervalo") == 0 && i + 1 < argc) {
+            cfg->checkpoint_intervalo = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--retomar") == 0 && i + 1 < argc) {
+            arquivo_retomada = argv[++i];
+        } else if (strcmp(argv[i], "--planejar") == 0 && i + 2 < argc) {
+            modo_planejador = 1;
+            meta_metrica = argv[++i];
+            meta_limite = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-pistas") == 0 && i + 1 < argc) {
+            max_pistas = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-portoes") == 0 && i + 1 < argc) {
+            max_portoes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-torre") == 0 && i + 1 < argc) {
+            max_torre = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--custo") == 0 && i + 3 < argc) {
+            custo_recurso[0] = atoi(argv[++i]);
+            custo_recurso[1] = atoi(argv[++i]);
+            custo_recurso[2] = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--replicar") == 0 && i + 2 < argc) {
+            modo_replicacao = 1;
+            max_replicacoes = atoi(argv[++i]);
+            precisao_replicacao = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--paralelo") == 0 && i + 1 < argc) {
+            paralelo = atoi(argv[++i]);
         } else if (strcmp(argv[i], "--help") == 0) {
+            simulacao_config_t padrao;
+            simulacao_config_padrao(&padrao);
             printf("Uso: %s [opções]\n", argv[0]);
             printf("  --pistas N      Número de pistas (padrão: 3)\n");
             printf("  --portoes N     Número de portões (padrão: 5)\n");
@@ -912,186 +589,111 @@ int main(int argc, char *argv[]) {
             printf("  --intervalo MIN MAX  Intervalo aleatório entre aviões em ms (padrão: 1000 3000)\n");
             printf("  --intervalo-min N    Intervalo mínimo em ms (padrão: 1000)\n");
             printf("  --intervalo-max N    Intervalo máximo em ms (padrão: 3000)\n");
+            printf("  --recurso NOME N     Declara um tipo de recurso (ou altera a capacidade de um existente)\n");
+            printf("  --fase FASE TIPO LISTA  Recursos da fase para DOM, INTL ou AMBOS, ex.: pista,torre,taxiway@500\n");
+            printf("                       (@ms mantém o recurso por mais ms após o serviço)\n");
+            printf("  --servico FASE TIPO DIST  Tempo de serviço da fase para DOM, INTL ou AMBOS: uniforme:MIN:MAX,\n");
+            printf("                       lognormal:MEDIANA:SIGMA, gama:FORMA:ESCALA (em s) ou empirica:ARQUIVO\n");
+            printf("  --config ARQUIVO     Lê declarações 'recurso', 'fase' e 'servico' de um arquivo\n");
+            printf("  --politica NOME      Ordem de concessão dos recursos: fifo, prioridade, edf ou wfq (padrão: prioridade)\n");
+            printf("  --max-ativos N       Máximo de aviões ativos simultâneos, 0 = sem limite (padrão: %d)\n", padrao.max_ativos);
+            printf("  --fila-espera N      Capacidade da fila de espera em voo (padrão: %d)\n", padrao.fila_espera);
+            printf("  --espera-max N       Tempo máximo em espera antes do desvio em s (padrão: %d)\n", padrao.espera_max);
+            printf("  --fila-pouso N       Retém chegadas com N aviões aguardando pista ou torre, 0 = sem limite (padrão: %d)\n", padrao.fila_pouso);
+            printf("  --perfil-locks       Mede aquisições, contenção, espera e posse de cada mutex\n");
+            printf("  --drenagem N         Prazo em s para os aviões ativos terminarem após o tempo (0 = sem prazo, padrão: %d)\n", padrao.drenagem);
+            printf("  --semente N          Semente do gerador aleatório (padrão: hora atual)\n");
+            printf("  --exportar PREFIXO   Exporta o ciclo de vida de cada voo em PREFIXO.bin e PREFIXO.csv\n");
+            printf("  --trace ARQUIVO      Grava a linha do tempo dos voos e recursos (Trace Event Format)\n");
+            printf("  --checkpoint ARQUIVO Grava o estado em ARQUIVO (e os voos concluídos em ARQUIVO.voos)\n");
+            printf("                       periodicamente, com SIGUSR1 e ao interromper com Ctrl+C\n");
+            printf("  --checkpoint-intervalo N  Segundos entre checkpoints periódicos (padrão: %d)\n", padrao.checkpoint_intervalo);
+            printf("  --retomar ARQUIVO    Continua a simulação a partir de um checkpoint\n");
+            printf("\nPlanejador de capacidade:\n");
+            printf("  --planejar METRICA LIMITE  Busca a configuração mais barata com METRICA <= LIMITE%%\n");
+            printf("                             (METRICA: quedas, starvation ou alertas)\n");
+            printf("  --max-pistas N       Limite superior de pistas na busca (padrão: 10)\n");
+            printf("  --max-portoes N      Limite superior de portões na busca (padrão: 16)\n");
+            printf("  --max-torre N        Limite superior da torre na busca (padrão: 6)\n");
+            printf("  --custo P G T        Custo unitário de pista, portão e torre (padrão: 1 1 1)\n");
+            printf("  --paralelo N         Simulações candidatas simultâneas (padrão: 4, máx: %d)\n", MAX_PARALELO);
+            printf("\nReplicações independentes:\n");
+            printf("  --replicar K PRECISAO  Até K sementes (a partir de --semente) em paralelo, até a largura do\n");
+            printf("                       IC 95%% de sucessos e quedas ficar abaixo de PRECISAO pontos percentuais\n");
             exit(0);
         }
     }
     
-    if (intervalo_min >= intervalo_max) {
-        printf("ERRO: Intervalo mínimo (%d) deve ser menor que máximo (%d)\n", 
-               intervalo_min, intervalo_max);
+    if (arquivo_retomada != NULL) {
+        if (modo_planejador || modo_replicacao) {
+            printf("ERRO: --retomar vale apenas para uma execucao simples\n");
+            exit(1);
+        }
+        if (simulacao_retomar(modelo, arquivo_retomada) != 0) exit(1);
+    }
+    if (cfg->checkpoint != NULL && cfg->checkpoint_intervalo < 1) {
+        printf("ERRO: Intervalo de checkpoint deve ser maior que zero\n");
         exit(1);
     }
     
-    init_resource(&pistas, num_pistas, 0);
-    init_resource(&portoes, num_portoes, 0);
-    init_resource(&torre, capacidade_torre, 1); 
-    start_time = time(NULL);
-    
-    log_msg("=== SIMULACAO INICIADA ===");
-    char config_msg[200];
-    snprintf(config_msg, sizeof(config_msg), 
-             "CONFIGURACAO: Pistas=%d, Portoes=%d, Torre=%d, Tempo=%ds, Intervalo=%d-%dms", 
-             num_pistas, num_portoes, capacidade_torre, tempo_sim, intervalo_min, intervalo_max);
-    log_msg(config_msg);
-    
-    pthread_t monitor_tid, aging_tid, deadlock_tid;
-    pthread_create(&monitor_tid, NULL, monitor_thread, NULL);
-    pthread_create(&aging_tid, NULL, aging_thread, NULL);
-    pthread_create(&deadlock_tid, NULL, deadlock_detection_thread, NULL);
-    
-    while (simulation_running && (time(NULL) - start_time) < tempo_sim) {
-        if (airplane_counter < MAX_AVIOES) {
-            pthread_mutex_lock(&avioes_mutex);
-            airplane_t* plane = &avioes[airplane_counter];
-            plane->id = airplane_counter++;
-            plane->type = rand() % 2;
-            pthread_mutex_unlock(&avioes_mutex);
-            pthread_create(&plane->thread_id, NULL, airplane_thread, plane);
-        }
-
-        int intervalo_range = intervalo_max - intervalo_min;
-        int intervalo_aleatorio = intervalo_min + (rand() % (intervalo_range + 1));
-        usleep(intervalo_aleatorio * 1000); 
+    if (cfg->fila_espera < 1 || cfg->espera_max < 1 || cfg->max_ativos < 0 || cfg->fila_pouso < 0) {
+        printf("ERRO: Parametros de admissao invalidos\n");
+        exit(1);
     }
     
-    log_msg("=== TEMPO ESGOTADO - Aguardando avioes ativos ===");
-    
-    while (simulation_running) {
-        pthread_mutex_lock(&stats_mutex);
-        int avioes_ativos = ativos;
-        pthread_mutex_unlock(&stats_mutex);
-        
-        if (avioes_ativos == 0) {
-            log_msg("Todos os avioes finalizaram!");
-            break;
-        }
-        sleep(2);
+    if (cfg->pistas < 1 || cfg->portoes < 1 || cfg->torre < 1) {
+        printf("ERRO: Pistas, portoes e torre devem ser maiores que zero\n");
+        exit(1);
     }
     
-    simulation_running = 0;
-    
-    pthread_cond_broadcast(&pistas.cond);
-    pthread_cond_broadcast(&portoes.cond);
-    pthread_cond_broadcast(&torre.cond);
-    
-    for (int i = 0; i < airplane_counter; i++) {
-        pthread_join(avioes[i].thread_id, NULL);
+    if (cfg->intervalo_min >= cfg->intervalo_max) {
+        printf("ERRO: Intervalo mínimo (%d) deve ser menor que máximo (%d)\n", 
+               cfg->intervalo_min, cfg->intervalo_max);
+        exit(1);
     }
-    pthread_join(monitor_tid, NULL);
-    pthread_join(aging_tid, NULL);
-    pthread_join(deadlock_tid, NULL);
     
-    printf("\n==================================================================\n");
-    printf("                    RELATORIO FINAL                               \n");
-    printf("==================================================================\n");
-    printf("CONFIGURACAO: Pistas=%d, Portoes=%d, Torre=%d, Tempo=%ds\n", 
-           num_pistas, num_portoes, capacidade_torre, tempo_sim);
-    printf("\nRESUMO GERAL:\n");
-    printf("Total de avioes: %d\n", total_avioes);
-    printf("├─ Domesticos: %d (%.1f%%)\n", domesticos, 
-           total_avioes > 0 ? (float)domesticos/total_avioes*100 : 0);
-    printf("└─ Internacionais: %d (%.1f%%)\n", internacionais,
-           total_avioes > 0 ? (float)internacionais/total_avioes*100 : 0);
-    printf("\nRESULTADOS:\n");
-    printf("Sucessos: %d (%.1f%%)\n", sucessos, 
-           total_avioes > 0 ? (float)sucessos/total_avioes*100 : 0);
-    printf("Quedas: %d (%.1f%%)\n", quedas,
-           total_avioes > 0 ? (float)quedas/total_avioes*100 : 0);
-    printf("\nPROBLEMAS DETECTADOS:\n");
-    printf("Alertas Criticos: %d\n", alertas_criticos);
-    printf("Casos de Starvation: %d\n", starvation_casos);
-    printf("Deadlocks Detectados: %d\n", deadlocks_detectados);
-    printf("Deadlocks Resolvidos: %d\n", deadlocks_resolvidos);
-    printf("Deadlocks Evitados (Backoff): %d\n", deadlocks_evitados);
-    printf("Preempcoes Realizadas: %d\n", preempcoes_realizadas);
-    printf("\nESTADO FINAL DOS AVIOES:\n");
-    
-    int sucessos_dom = 0, sucessos_int = 0, quedas_dom = 0, quedas_int = 0;
-    for (int i = 0; i < airplane_counter; i++) {
-        const char* estado_str;
-        switch(avioes[i].estado) {
-            case 3: estado_str = "SUCESSO"; break;
-            case -1: estado_str = "QUEDA"; break;
-            case 0: estado_str = "POUSO"; break;
-            case 1: estado_str = "DESEMBARQUE"; break;
-            case 2: estado_str = "DECOLAGEM"; break;
-            default: estado_str = "DESCONHECIDO"; break;
+    if (modo_planejador) {
+        if (strcmp(meta_metrica, "quedas") != 0 && strcmp(meta_metrica, "starvation") != 0 &&
+            strcmp(meta_metrica, "alertas") != 0) {
+            printf("ERRO: Metrica desconhecida '%s' (use quedas, starvation ou alertas)\n", meta_metrica);
+            exit(1);
         }
-        
-        if (avioes[i].estado == 3) {
-            if (avioes[i].type == VOO_DOMESTICO) sucessos_dom++;
-            else sucessos_int++;
-        } else if (avioes[i].estado == -1) {
-            if (avioes[i].type == VOO_DOMESTICO) quedas_dom++;
-            else quedas_int++;
+        if (max_pistas < 1 || max_portoes < 1 || max_torre < 1) {
+            printf("ERRO: Limites da busca devem ser maiores que zero\n");
+            exit(1);
         }
+        if (paralelo < 1) paralelo = 1;
+        if (paralelo > MAX_PARALELO) paralelo = MAX_PARALELO;
         
-        if (i < 10 || avioes[i].estado != 3) { 
-            printf("Aviao %d (%s): %s\n", avioes[i].id, 
-                   avioes[i].type ? "INTL" : "DOM", estado_str);
-        }
+        return planejar_capacidade();
     }
     
-    printf("\nDETALHES POR TIPO:\n");
-    printf("Domesticos - Sucessos: %d, Quedas: %d\n", sucessos_dom, quedas_dom);
-    printf("Internacionais - Sucessos: %d, Quedas: %d\n", sucessos_int, quedas_int);
-    printf("\nEFICIENCIA DO SISTEMA:\n");
-    printf("Taxa de Sucesso: %.1f%%\n", 
-           total_avioes > 0 ? (float)sucessos/total_avioes*100 : 0);
-    printf("Taxa de Utilizacao (estimada): %.1f%%\n",
-           total_avioes > 0 ? (float)sucessos/(tempo_sim/10.0)*100 : 0);
-    printf("==================================================================\n");
-    
-    pthread_mutex_lock(&critical_mutex);
-    critical_airplane_t* current = critical_list;
-    while (current != NULL) {
-        critical_airplane_t* next = current->next;
-        free(current);
-        current = next;
+    if (modo_replicacao) {
+        if (max_replicacoes < MIN_REPLICACOES || max_replicacoes > MAX_REPLICACOES || precisao_replicacao <= 0) {
+            printf("ERRO: Use --replicar K PRECISAO com %d <= K <= %d e PRECISAO > 0\n",
+                   MIN_REPLICACOES, MAX_REPLICACOES);
+            exit(1);
+        }
+        if (paralelo < 1) paralelo = 1;
+        if (paralelo > MAX_PARALELO) paralelo = MAX_PARALELO;
+        
+        return replicar_simulacao();
     }
-    critical_list = NULL;
-    pthread_mutex_unlock(&critical_mutex);
-    
-    pthread_mutex_lock(&deadlock_mutex);
     
-    resource_holder_t* holder = pistas_holders;
-    while (holder != NULL) {
-        resource_holder_t* next = holder->next;
-        free(holder);
-        holder = next;
-    }
-    holder = portoes_holders;
-    while (holder != NULL) {
-        resource_holder_t* next = holder->next;
-        free(holder);
-        holder = next;
-    }
-    holder = torre_holders;
-    while (holder != NULL) {
-        resource_holder_t* next = holder->next;
-        free(holder);
-        holder = next;
+    simulacoes_ativas[0] = modelo;
+    if (simulacao_executar(modelo) != 0) {
+        printf("ERRO: Nao foi possivel iniciar a simulacao: %s\n", strerror(errno));
+        exit(1);
     }
-    
-    waiting_thread_t* waiting = waiting_threads;
-    while (waiting != NULL) {
-        waiting_thread_t* next = waiting->next;
-        free(waiting);
-        waiting = next;
+    retirar_ativa(0);
+    simulacao_imprimir_relatorio(modelo, stdout);
+    if (prefixo_exportacao != NULL) {
+        int n = simulacao_exportar_registros(modelo, prefixo_exportacao);
+        if (n >= 0) {
+            printf("Registros de %d voos exportados para %s.bin e %s.csv\n", n, prefixo_exportacao, prefixo_exportacao);
+        }
     }
-    
-    pthread_mutex_unlock(&deadlock_mutex);
-    
-    pthread_mutex_destroy(&pistas.mutex);
-    pthread_cond_destroy(&pistas.cond);
-    pthread_mutex_destroy(&portoes.mutex);
-    pthread_cond_destroy(&portoes.cond);
-    pthread_mutex_destroy(&torre.mutex);
-    pthread_cond_destroy(&torre.cond);
-    pthread_cond_destroy(&torre.cond_dom);
-    pthread_mutex_destroy(&stats_mutex);
-    pthread_mutex_destroy(&critical_mutex);
-    pthread_mutex_destroy(&deadlock_mutex);
+    simulacao_destruir(modelo);
     
     return 0;
 }
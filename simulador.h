@@ -0,0 +1,85 @@
+#ifndef SIMULADOR_H
+#define SIMULADOR_H
+
+#include <stdio.h>
+
+// Simulador de tráfego aéreo como biblioteca: todo o estado de uma simulação
+// fica em um simulacao_t, de modo que várias simulações podem existir e
+// executar ao mesmo tempo no mesmo processo.
+//
+// Uso típico:
+//   simulacao_t* sim = simulacao_criar(NULL);
+//   simulacao_config(sim)->tempo = 120;
+//   simulacao_executar(sim);
+//   simulacao_resultados(sim, &res);
+//   simulacao_destruir(sim);
+
+typedef struct simulacao simulacao_t;
+
+typedef struct {
+    int pistas, portoes, torre;
+    int tempo;                          // duração em s
+    int intervalo_min, intervalo_max;   // entre chegadas, em ms
+    int max_ativos;                     // 0 = sem limite
+    int fila_espera;                    // capacidade da espera em voo
+    int espera_max;                     // s em espera antes do desvio
+    int fila_pouso;                     // esperas nos recursos de pouso que retêm chegadas, 0 = sem limite
+    int drenagem;                       // s para os ativos terminarem, 0 = sem prazo
+    unsigned semente;
+    int perfil_locks;
+    const char* trace;                  // arquivo Trace Event Format ou NULL
+    const char* checkpoint;             // arquivo de checkpoint ou NULL
+    int checkpoint_intervalo;           // s entre checkpoints periódicos
+    FILE* saida;                        // logs e status; NULL = silenciosa
+} simulacao_config_t;
+
+typedef struct {
+    int pistas, portoes, torre;
+    int total, sucessos, quedas;
+    int alertas, starvation;
+    int admitidos, desviados;
+    long long espera_p50, espera_p95, espera_p99;
+} simulacao_resultados_t;
+
+void simulacao_config_padrao(simulacao_config_t* cfg);
+
+// cfg == NULL usa simulacao_config_padrao. Retorna NULL sem memória.
+simulacao_t* simulacao_criar(const simulacao_config_t* cfg);
+
+// Nova simulação, ainda não executada, com a mesma configuração, recursos,
+// fases e política do modelo.
+simulacao_t* simulacao_clonar(const simulacao_t* modelo);
+
+// Configuração alterável até simulacao_executar.
+simulacao_config_t* simulacao_config(simulacao_t* sim);
+
+int simulacao_declarar_recurso(simulacao_t* sim, const char* nome, int capacidade);
+int simulacao_definir_fase(simulacao_t* sim, const char* fase, const char* tipo, const char* lista);
+
+// Distribuição do tempo de serviço de uma fase: uniforme:MIN:MAX,
+// lognormal:MEDIANA:SIGMA, gama:FORMA:ESCALA (segundos) ou empirica:ARQUIVO.
+int simulacao_definir_servico(simulacao_t* sim, const char* fase, const char* tipo, const char* distribuicao);
+int simulacao_carregar_configuracao(simulacao_t* sim, const char* caminho);
+int simulacao_definir_politica(simulacao_t* sim, const char* nome);
+
+// Bloqueia até o fim da simulação (tempo esgotado e drenagem, ou
+// simulacao_encerrar). Cada simulação executa uma única vez.
+int simulacao_executar(simulacao_t* sim);
+
+// Pode ser chamada de outra thread ou de um tratador de sinal. Com
+// checkpoint configurado, grava um último checkpoint antes de encerrar.
+void simulacao_encerrar(simulacao_t* sim);
+
+// Pede um checkpoint imediato; também segura em tratador de sinal.
+void simulacao_checkpoint(simulacao_t* sim);
+
+// Carrega configuração e estado de um checkpoint em uma simulação ainda não
+// executada; simulacao_executar continua de onde o checkpoint parou.
+int simulacao_retomar(simulacao_t* sim, const char* caminho);
+
+void simulacao_resultados(simulacao_t* sim, simulacao_resultados_t* res);
+void simulacao_imprimir_relatorio(simulacao_t* sim, FILE* saida);
+int simulacao_exportar_registros(simulacao_t* sim, const char* prefixo);
+void simulacao_destruir(simulacao_t* sim);
+
+#endif
@@ -0,0 +1,764 @@
+// Testes das partes determinísticas do simulador. As fontes são incluídas
+// diretamente para alcançar as funções static.
+//
+//   gcc -o testes_aeroporto testes/testes.c -lpthread -lm -Wall -Wextra && ./testes_aeroporto
+
+#include "../simulador.c"
+
+#define main aeroporto_main
+#include "../Aeroporto.c"
+#undef main
+
+#include <limits.h>
+
+static int falhas = 0;
+static int verificacoes = 0;
+
+#define VERIFICAR(condicao) do { \
+    verificacoes++; \
+    if (!(condicao)) { \
+        falhas++; \
+        printf("FALHOU: %s:%d: %s\n", __FILE__, __LINE__, #condicao); \
+    } \
+} while (0)
+
+#define PROXIMO(a, b, tolerancia) VERIFICAR(fabs((double)(a) - (double)(b)) <= (tolerancia))
+
+// Insere as esperas na ordem dada e confere a ordem em que a fila as entrega.
+static void conferir_ordem(simulacao_t* sim, const char* politica, espera_t* esperas, int n, const int* esperado) {
+    resource_t res = {.capacidade = 1};
+    simulacao_definir_politica(sim, politica);
+    init_resource(sim, &res);
+    for (int i = 0; i < n; i++) {
+        esperas[i].ordem = res.proxima_ordem++;
+        esperas[i].chave = res.politica->chave(&res, &esperas[i]);
+        fila_inserir(&res, &esperas[i]);
+    }
+    for (int i = 0; i < n; i++) {
+        espera_t* w = fila_retirar(&res);
+        VERIFICAR(w != NULL && w->aviao_id == esperado[i]);
+    }
+    VERIFICAR(res.fila_tam == 0);
+    free(res.fila);
+    pthread_mutex_destroy(&res.mutex);
+}
+
+static void teste_politicas() {
+    espera_t a = {.ordem = 1, .chave = 0}, b = {.ordem = 2, .chave = 0}, c = {.ordem = 0, .chave = 1};
+    VERIFICAR(espera_antes(&a, &b));
+    VERIFICAR(!espera_antes(&b, &a));
+    VERIFICAR(espera_antes(&b, &c));
+    VERIFICAR(!espera_antes(&a, &a));
+
+    simulacao_t* sim = simulacao_criar(NULL);
+
+    espera_t esperas[6];
+    const int tipos[6] = {VOO_DOMESTICO, VOO_INTERNACIONAL, VOO_DOMESTICO, VOO_INTERNACIONAL, VOO_DOMESTICO, VOO_DOMESTICO};
+    const time_t inicios[6] = {50, 40, 10, 30, 20, 60};
+    for (int i = 0; i < 6; i++) {
+        memset(&esperas[i], 0, sizeof(esperas[i]));
+        esperas[i].aviao_id = i;
+        esperas[i].type = tipos[i];
+        esperas[i].tempo_inicio = inicios[i];
+    }
+
+    const int fifo[6] = {0, 1, 2, 3, 4, 5};
+    const int prioridade[6] = {1, 3, 0, 2, 4, 5};
+    const int edf[6] = {2, 4, 3, 1, 0, 5};
+    conferir_ordem(sim, "fifo", esperas, 6, fifo);
+    conferir_ordem(sim, "prioridade", esperas, 6, prioridade);
+    conferir_ordem(sim, "edf", esperas, 6, edf);
+
+    // WFQ com peso 2 para INTL: dois internacionais para cada doméstico.
+    espera_t wfq[9];
+    for (int i = 0; i < 9; i++) {
+        memset(&wfq[i], 0, sizeof(wfq[i]));
+        wfq[i].aviao_id = i;
+        wfq[i].type = i < 3 ? VOO_DOMESTICO : VOO_INTERNACIONAL;
+    }
+    const int ordem_wfq[9] = {3, 0, 4, 5, 1, 6, 7, 2, 8};
+    conferir_ordem(sim, "wfq", wfq, 9, ordem_wfq);
+
+    // Remover do meio da fila preserva a ordem do restante.
+    resource_t res = {.capacidade = 1};
+    simulacao_definir_politica(sim, "fifo");
+    init_resource(sim, &res);
+    for (int i = 0; i < 6; i++) {
+        esperas[i].ordem = res.proxima_ordem++;
+        esperas[i].chave = 0;
+        fila_inserir(&res, &esperas[i]);
+    }
+    fila_remover(&res, &esperas[2]);
+    fila_remover(&res, &esperas[0]);
+    VERIFICAR(esperas[2].fila_idx == -1);
+    const int restantes[4] = {1, 3, 4, 5};
+    for (int i = 0; i < 4; i++) {
+        espera_t* w = fila_retirar(&res);
+        VERIFICAR(w->aviao_id == restantes[i]);
+    }
+    free(res.fila);
+    pthread_mutex_destroy(&res.mutex);
+    simulacao_destruir(sim);
+}
+
+static void teste_quantil_normal() {
+    PROXIMO(quantil_normal(0.5), 0.0, 1e-9);
+    PROXIMO(quantil_normal(0.975), 1.959964, 1e-6);
+    PROXIMO(quantil_normal(0.025), -1.959964, 1e-6);
+    PROXIMO(quantil_normal(0.999), 3.090232, 1e-6);
+    PROXIMO(quantil_normal(1e-6), -4.753424, 1e-5);
+    PROXIMO(quantil_normal(0.1) + quantil_normal(0.9), 0.0, 1e-9);
+}
+
+static double media_amostras(const servico_t* servico, int n, long long* minimo, long long* maximo) {
+    unsigned semente = 12345;
+    double soma = 0;
+    *minimo = LLONG_MAX;
+    *maximo = LLONG_MIN;
+    for (int i = 0; i < n; i++) {
+        long long v = amostrar_servico(servico, &semente);
+        soma += v;
+        if (v < *minimo) *minimo = v;
+        if (v > *maximo) *maximo = v;
+    }
+    return soma / n;
+}
+
+static void teste_servicos() {
+    servico_t servico;
+    long long minimo, maximo;
+
+    VERIFICAR(compilar_servico(&servico, "uniforme:3:8") == 0);
+    PROXIMO(servico.quantis[0], 3000, 1e-3);
+    PROXIMO(servico.quantis[QUANTIS_SERVICO], 8000, 1e-3);
+    PROXIMO(media_amostras(&servico, 200000, &minimo, &maximo), 5500, 20);
+    VERIFICAR(minimo >= 3000 && maximo <= 8000);
+
+    VERIFICAR(compilar_servico(&servico, "lognormal:3.5:0.4") == 0);
+    PROXIMO(servico.quantis[QUANTIS_SERVICO / 2], 3500, 1);
+    PROXIMO(media_amostras(&servico, 200000, &minimo, &maximo), 3500 * exp(0.4 * 0.4 / 2), 30);
+
+    VERIFICAR(compilar_servico(&servico, "gama:2:1.5") == 0);
+    PROXIMO(media_amostras(&servico, 200000, &minimo, &maximo), 3000, 30);
+    VERIFICAR(minimo >= 0);
+    for (int i = 1; i <= QUANTIS_SERVICO; i++) {
+        VERIFICAR(servico.quantis[i] >= servico.quantis[i - 1]);
+    }
+
+    // Histograma com metade do peso em [1, 2) s e metade em [2, 4) s.
+    char caminho[256];
+    snprintf(caminho, sizeof(caminho), "%s/aeroporto_teste_%d.hist", getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp", (int)getpid());
+    FILE* arquivo = fopen(caminho, "w");
+    VERIFICAR(arquivo != NULL);
+    if (arquivo != NULL) {
+        fprintf(arquivo, "# inicio fim peso\n1 2 5\n2 4 5\n");
+        fclose(arquivo);
+        char distribuicao[300];
+        snprintf(distribuicao, sizeof(distribuicao), "empirica:%s", caminho);
+        VERIFICAR(compilar_servico(&servico, distribuicao) == 0);
+        PROXIMO(servico.quantis[0], 1000, 1e-3);
+        PROXIMO(servico.quantis[QUANTIS_SERVICO / 2], 2000, 1e-3);
+        PROXIMO(servico.quantis[QUANTIS_SERVICO], 4000, 1e-3);
+        unlink(caminho);
+    }
+
+    VERIFICAR(compilar_servico(&servico, "uniforme:8:3") != 0);
+    VERIFICAR(compilar_servico(&servico, "normal:1:1") != 0);
+
+    // Padrões: 3-8 s no pouso, 3-7 s no desembarque e 2-5 s na decolagem.
+    simulacao_t* sim = simulacao_criar(NULL);
+    const int limites[NUM_FASES][2] = {{3000, 8000}, {3000, 7000}, {2000, 5000}};
+    for (int f = 0; f < NUM_FASES; f++) {
+        for (int t = VOO_DOMESTICO; t <= VOO_INTERNACIONAL; t++) {
+            PROXIMO(sim->servicos[t][f].quantis[0], limites[f][0], 1e-3);
+            PROXIMO(sim->servicos[t][f].quantis[QUANTIS_SERVICO], limites[f][1], 1e-3);
+        }
+    }
+    simulacao_destruir(sim);
+}
+
+static void teste_intervalo_confianca() {
+    PROXIMO(t_critico_95(1), 12.706, 1e-9);
+    PROXIMO(t_critico_95(30), 2.042, 1e-9);
+    PROXIMO(t_critico_95(45), 2.000, 1e-9);
+    PROXIMO(t_critico_95(100), 1.980, 1e-9);
+    PROXIMO(t_critico_95(1000), 1.960, 1e-9);
+
+    const double valores[5] = {1, 2, 3, 4, 5};
+    double media, semi;
+    intervalo_confianca(valores, 5, &media, &semi);
+    PROXIMO(media, 3.0, 1e-12);
+    PROXIMO(semi, 2.776 * sqrt(2.5) / sqrt(5), 1e-9);
+
+    intervalo_confianca(valores, 1, &media, &semi);
+    PROXIMO(media, 1.0, 1e-12);
+    PROXIMO(semi, 0.0, 1e-12);
+}
+
+static void teste_roda() {
+    const long long prazos_ms[] = {0, 5, 15, 630, 640, 650, 41000, 41010, 2700000, 90000};
+    const int n = sizeof(prazos_ms) / sizeof(prazos_ms[0]);
+    temporizador_t timers[sizeof(prazos_ms) / sizeof(prazos_ms[0])];
+    long long disparo[sizeof(prazos_ms) / sizeof(prazos_ms[0])];
+
+    simulacao_t* sim = simulacao_criar(NULL);
+    sim->roda_atual = 0;
+    for (int i = 0; i < n; i++) {
+        memset(&timers[i], 0, sizeof(timers[i]));
+        timers[i].aviao_id = i;
+        timers[i].expira = prazos_ms[i];
+        roda_inserir(sim, &timers[i]);
+        disparo[i] = -1;
+    }
+    sim->roda_armados = n;
+    VERIFICAR(roda_proximo_tick(sim) == 0);
+
+    // Cancelado antes de vencer: nunca dispara.
+    roda_remover(&timers[n - 1]);
+    sim->roda_armados--;
+    VERIFICAR(timers[n - 1].ref == NULL);
+
+    long long ultimo_tick = prazos_ms[n - 2] / RESOLUCAO_RODA_MS;
+    while (sim->roda_armados > 0 && sim->roda_atual <= ultimo_tick) {
+        // A thread da roda dorme até roda_proximo_tick: pular direto para
+        // ele não pode atrasar nenhum timer.
+        long long proximo = roda_proximo_tick(sim);
+        VERIFICAR(proximo >= sim->roda_atual);
+        while (sim->roda_atual < proximo) {
+            roda_avancar(sim);
+            VERIFICAR(sim->roda_vencidos == NULL);
+        }
+        roda_avancar(sim);
+        while (sim->roda_vencidos != NULL) {
+            temporizador_t* t = sim->roda_vencidos;
+            roda_remover(t);
+            sim->roda_armados--;
+            disparo[t->aviao_id] = sim->roda_atual - 1;
+        }
+    }
+
+    for (int i = 0; i < n - 1; i++) {
+        VERIFICAR(disparo[i] == prazos_ms[i] / RESOLUCAO_RODA_MS);
+    }
+    VERIFICAR(disparo[n - 1] == -1);
+    VERIFICAR(sim->roda_armados == 0);
+    simulacao_destruir(sim);
+}
+
+static void teste_estado_recurso() {
+    VERIFICAR(ESTADO_LIVRES(3u | 2u * ESTADO_ESPERA_UM) == 3);
+    VERIFICAR(ESTADO_ESPERAS(3u | 2u * ESTADO_ESPERA_UM) == 2);
+    VERIFICAR(ESTADO_LIVRES((unsigned)CAPACIDADE_MAX_RECURSO) == CAPACIDADE_MAX_RECURSO);
+    VERIFICAR(ESTADO_ESPERAS((unsigned)CAPACIDADE_MAX_RECURSO) == 0);
+
+    simulacao_t* sim = simulacao_criar(NULL);
+    resource_t res = {.capacidade = 2};
+    init_resource(sim, &res);
+    VERIFICAR(atomic_load(&res.estado) == 2u);
+
+    unsigned estado;
+    VERIFICAR(tomar_unidade(&res, &estado) && ESTADO_LIVRES(estado) == 1);
+    VERIFICAR(tomar_unidade(&res, &estado) && ESTADO_LIVRES(estado) == 0);
+    VERIFICAR(!tomar_unidade(&res, &estado));
+    VERIFICAR(devolver_unidade(&res, &estado) && ESTADO_LIVRES(estado) == 1);
+
+    // Com alguém na fila, o caminho rápido não toma nem devolve unidades.
+    atomic_fetch_add(&res.estado, ESTADO_ESPERA_UM);
+    VERIFICAR(!tomar_unidade(&res, &estado));
+    VERIFICAR(!devolver_unidade(&res, &estado));
+    VERIFICAR(ESTADO_LIVRES(atomic_load(&res.estado)) == 1);
+    VERIFICAR(ESTADO_ESPERAS(atomic_load(&res.estado)) == 1);
+
+    pthread_mutex_destroy(&res.mutex);
+    simulacao_destruir(sim);
+}
+
+// Monta o estado que simulacao_executar prepararia, sem iniciar threads.
+static simulacao_t* simulacao_preparada(const char* checkpoint) {
+    simulacao_t* sim = simulacao_criar(NULL);
+    simulacao_config_t* cfg = simulacao_config(sim);
+    cfg->checkpoint = checkpoint;
+    cfg->max_ativos = 8;
+    cfg->semente = 77;
+    simulacao_declarar_recurso(sim, "taxiway", 4);
+    simulacao_definir_fase(sim, "pouso", "AMBOS", "pista,torre,taxiway@500");
+    simulacao_definir_servico(sim, "decolagem", "INTL", "lognormal:2:0.3");
+
+    sim->recursos[RECURSO_PISTA].capacidade = sim->cfg.pistas;
+    sim->recursos[RECURSO_PORTAO].capacidade = sim->cfg.portoes;
+    sim->recursos[RECURSO_TORRE].capacidade = sim->cfg.torre;
+    for (int r = 0; r < sim->num_recursos; r++) init_resource(sim, &sim->recursos[r]);
+    clock_gettime(CLOCK_MONOTONIC, &sim->inicio_monotonico);
+    sim->fila_chegadas = malloc(sim->cfg.fila_espera * sizeof(chegada_t));
+    if (init_registros(sim) != 0) return NULL;
+    if (checkpoint != NULL) {
+        char caminho[520];
+        snprintf(caminho, sizeof(caminho), "%s.voos", checkpoint);
+        sim->checkpoint_voos_fd = open(caminho, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    }
+    sim->executada = 1;
+    return sim;
+}
+
+// Coloca um voo na posição dele, como lancar_voo faz.
+static airplane_t* ocupar_posicao(simulacao_t* sim, int aviao_id, int type) {
+    airplane_t* plane = voo(sim, aviao_id);
+    voo_escrita_inicio(plane);
+    plane->id = aviao_id;
+    plane->type = type;
+    atomic_store(&plane->estado, FASE_POUSO);
+    atomic_store(&plane->alarmes, 0);
+    atomic_store(&plane->retidos, 0);
+    atomic_store(&plane->ocupado, 1);
+    voo_escrita_fim(plane);
+    registro_voo_t* registro = registro_voo(sim, aviao_id);
+    memset(registro, 0, sizeof(*registro));
+    registro->id = aviao_id;
+    return plane;
+}
+
+static void teste_checkpoint() {
+    char caminho[256];
+    snprintf(caminho, sizeof(caminho), "%s/aeroporto_teste_%d.ckp", getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp", (int)getpid());
+
+    simulacao_t* sim = simulacao_preparada(caminho);
+    VERIFICAR(sim != NULL);
+    if (sim == NULL) return;
+
+    sim->total_avioes = 5;
+    sim->sucessos = 4;
+    sim->quedas = 1;
+    sim->admitidos = 7;
+    sim->desviados = 2;
+    atomic_store(&sim->airplane_counter, 7);
+
+    registro_voo_t concluido;
+    memset(&concluido, 0, sizeof(concluido));
+    concluido.id = 3;
+    concluido.tipo_estado = REGISTRO_TIPO_ESTADO(VOO_INTERNACIONAL, 3);
+    despejar_registro(sim, &concluido);
+
+    sim->fila_chegadas[0].type = VOO_DOMESTICO;
+    sim->fila_chegadas[0].chegada_ms = 1234;
+    sim->fila_chegadas_tam = 1;
+
+    airplane_t* plane = voo(sim, 6);
+    plane->id = 6;
+    plane->type = VOO_INTERNACIONAL;
+    plane->semente_rng = 99;
+    atomic_store(&plane->estado, FASE_DESEMBARQUE);
+    atomic_store(&plane->tempo_inicio, time(NULL));
+    atomic_store(&plane->alarmes, ALARME_ALERTA);
+    atomic_store(&plane->ocupado, 1);
+    registro_voo(sim, 6)->id = 6;
+    registro_voo(sim, 6)->backoffs = 2;
+
+    gravar_checkpoint(sim);
+    VERIFICAR(sim->checkpoints == 1);
+
+    simulacao_t* retomada = simulacao_criar(NULL);
+    VERIFICAR(simulacao_retomar(retomada, caminho) == 0);
+    retomada_t* r = retomada->retomada;
+    VERIFICAR(r != NULL);
+    if (r != NULL) {
+        VERIFICAR(retomada->cfg.max_ativos == 8 && retomada->cfg.semente == 77);
+        VERIFICAR(retomada->num_recursos == 4);
+        VERIFICAR(strcmp(retomada->recursos[3].nome, "taxiway") == 0 && retomada->recursos[3].capacidade == 4);
+        VERIFICAR(retomada->requisitos_por_tipo[VOO_DOMESTICO][FASE_POUSO].n == 3);
+        VERIFICAR(retomada->requisitos_por_tipo[VOO_DOMESTICO][FASE_POUSO].retencao_ms[2] == 500);
+        for (int t = 0; t < 2; t++) {
+            for (int f = 0; f < NUM_FASES; f++) {
+                VERIFICAR(memcmp(retomada->servicos[t][f].quantis, sim->servicos[t][f].quantis, sizeof(sim->servicos[t][f].quantis)) == 0);
+                VERIFICAR(strcmp(retomada->servicos[t][f].descricao, sim->servicos[t][f].descricao) == 0);
+            }
+        }
+        VERIFICAR(retomada->politica_ativa == sim->politica_ativa);
+        VERIFICAR(r->airplane_counter == 7);
+        VERIFICAR(r->contadores[0] == 5 && r->contadores[1] == 4 && r->contadores[2] == 1);
+        VERIFICAR(r->contadores[11] == 7 && r->contadores[12] == 2);
+        VERIFICAR(r->despejo_n == 1);
+        VERIFICAR(r->num_chegadas == 1 && r->chegadas[0].chegada_ms == 1234);
+        VERIFICAR(r->num_voos == 1);
+        if (r->num_voos == 1) {
+            VERIFICAR(r->voos[0].id == 6 && r->voos[0].type == VOO_INTERNACIONAL);
+            VERIFICAR(r->voos[0].estado == FASE_DESEMBARQUE && r->voos[0].alarmes == ALARME_ALERTA);
+            VERIFICAR(r->voos[0].semente_rng == 99 && r->voos[0].registro.backoffs == 2);
+        }
+    }
+    simulacao_destruir(retomada);
+
+    // Um voo com tipo fora do intervalo invalida o arquivo inteiro, e a
+    // simulação que tentou retomar continua com a configuração padrão.
+    atomic_store(&plane->estado, FASE_POUSO);
+    plane->type = 7;
+    gravar_checkpoint(sim);
+    retomada = simulacao_criar(NULL);
+    VERIFICAR(simulacao_retomar(retomada, caminho) != 0);
+    VERIFICAR(retomada->retomada == NULL && retomada->num_recursos == 3);
+    simulacao_destruir(retomada);
+    plane->type = VOO_INTERNACIONAL;
+
+    // Requisito apontando para um recurso que não existe.
+    sim->requisitos_por_tipo[VOO_DOMESTICO][FASE_POUSO].recurso[0] = MAX_RECURSOS;
+    gravar_checkpoint(sim);
+    retomada = simulacao_criar(NULL);
+    VERIFICAR(simulacao_retomar(retomada, caminho) != 0);
+    simulacao_destruir(retomada);
+    sim->requisitos_por_tipo[VOO_DOMESTICO][FASE_POUSO].recurso[0] = RECURSO_PISTA;
+
+    // Dois voos ativos na mesma posição da tabela: o id do primeiro voo
+    // gravado (posição 5) é trocado por um que cai na posição 6.
+    ocupar_posicao(sim, 5, VOO_DOMESTICO);
+    atomic_store(&sim->airplane_counter, 100);
+    gravar_checkpoint(sim);
+    FILE* arquivo = fopen(caminho, "r+b");
+    VERIFICAR(arquivo != NULL);
+    if (arquivo != NULL) {
+        int32_t id = 6 + sim->capacidade_voos;
+        fseek(arquivo, -2 * (long)sizeof(voo_checkpoint_t), SEEK_END);
+        long inicio = ftell(arquivo);
+        fwrite(&id, sizeof(id), 1, arquivo);
+        fseek(arquivo, inicio + offsetof(voo_checkpoint_t, registro) + offsetof(registro_voo_t, id), SEEK_SET);
+        fwrite(&id, sizeof(id), 1, arquivo);
+        fclose(arquivo);
+    }
+    retomada = simulacao_criar(NULL);
+    VERIFICAR(simulacao_retomar(retomada, caminho) != 0);
+    simulacao_destruir(retomada);
+    atomic_store(&voo(sim, 5)->ocupado, 0);
+    
+    // Arquivo truncado.
+    gravar_checkpoint(sim);
+    VERIFICAR(truncate(caminho, 100) == 0);
+    retomada = simulacao_criar(NULL);
+    VERIFICAR(simulacao_retomar(retomada, caminho) != 0);
+    simulacao_destruir(retomada);
+
+    simulacao_destruir(sim);
+    unlink(caminho);
+    char voos[300];
+    snprintf(voos, sizeof(voos), "%s.voos", caminho);
+    unlink(voos);
+}
+
+// Se o limite de ativos for reduzido depois de simulacao_retomar, a tabela
+// cresce até os voos retomados caberem cada um na sua posição.
+static void teste_retomada_tabela() {
+    simulacao_t* sim = simulacao_criar(NULL);
+    retomada_t r;
+    voo_checkpoint_t voos[2];
+    memset(&r, 0, sizeof(r));
+    memset(voos, 0, sizeof(voos));
+    voos[0].id = 6;
+    voos[1].id = 6 + 64;
+    r.voos = voos;
+    r.num_voos = 2;
+    VERIFICAR(voos_colidem(&r, 64) == 1);
+    VERIFICAR(voos_colidem(&r, 128) == 0);
+
+    simulacao_config(sim)->max_ativos = 8;
+    sim->retomada = &r;
+    VERIFICAR(init_registros(sim) == 0);
+    VERIFICAR(sim->capacidade_voos == 128);
+    VERIFICAR(voo(sim, voos[0].id) != voo(sim, voos[1].id));
+    sim->retomada = NULL;
+    liberar_registros(sim);
+    simulacao_destruir(sim);
+}
+
+typedef struct {
+    simulacao_t* sim;
+    airplane_t* plane;
+    atomic_int parar;
+    registro_voo_t copia;
+} escritor_registro_t;
+
+static void* copiar_registro(void* arg) {
+    escritor_registro_t* e = arg;
+    ler_registro(e->plane, registro_voo(e->sim, e->plane->id), &e->copia);
+    atomic_store(&e->parar, 1);
+    return NULL;
+}
+
+// Reescreve o registro inteiro com o mesmo valor em todos os marcos, como
+// registrar_marco faz campo a campo.
+static void* escrever_registros(void* arg) {
+    escritor_registro_t* e = arg;
+    registro_voo_t* registro = registro_voo(e->sim, e->plane->id);
+    for (int32_t k = 0; !atomic_load(&e->parar); k++) {
+        voo_escrita_inicio(e->plane);
+        registro->inicio_ms = k;
+        for (int f = 0; f < NUM_FASES; f++) {
+            registro->espera_inicio[f] = registro->concessao[f] = registro->fim_servico[f] = k;
+        }
+        voo_escrita_fim(e->plane);
+    }
+    return NULL;
+}
+
+// O checkpoint copia o registro de um voo ativo enquanto a thread do voo o
+// atualiza; a cópia nunca mistura duas versões.
+static void teste_registro_concorrente() {
+    simulacao_t* sim = simulacao_preparada(NULL);
+    VERIFICAR(sim != NULL);
+    if (sim == NULL) return;
+    escritor_registro_t e = {.sim = sim, .plane = ocupar_posicao(sim, 9, VOO_DOMESTICO)};
+    registro_voo_t* registro = registro_voo(sim, 9);
+
+    // Com a seção de escrita aberta e o registro pela metade, a cópia espera.
+    voo_escrita_inicio(e.plane);
+    registro->inicio_ms = 42;
+    pthread_t leitor;
+    pthread_create(&leitor, NULL, copiar_registro, &e);
+    usleep(50000);
+    VERIFICAR(!atomic_load(&e.parar));
+    for (int f = 0; f < NUM_FASES; f++) {
+        registro->espera_inicio[f] = registro->concessao[f] = registro->fim_servico[f] = 42;
+    }
+    voo_escrita_fim(e.plane);
+    pthread_join(leitor, NULL);
+    VERIFICAR(e.copia.inicio_ms == 42 && e.copia.fim_servico[FASE_DECOLAGEM] == 42);
+    atomic_store(&e.parar, 0);
+
+    pthread_t escritor;
+    pthread_create(&escritor, NULL, escrever_registros, &e);
+
+    int misturadas = 0;
+    for (int i = 0; i < 200000; i++) {
+        registro_voo_t copia;
+        ler_registro(e.plane, registro, &copia);
+        for (int f = 0; f < NUM_FASES; f++) {
+            if (copia.espera_inicio[f] != copia.inicio_ms || copia.concessao[f] != copia.inicio_ms ||
+                copia.fim_servico[f] != copia.inicio_ms) {
+                misturadas++;
+            }
+        }
+    }
+    atomic_store(&e.parar, 1);
+    pthread_join(escritor, NULL);
+    VERIFICAR(misturadas == 0);
+    simulacao_destruir(sim);
+}
+
+static void reter_pista(simulacao_t* sim, int aviao_id) {
+    unsigned estado;
+    VERIFICAR(tomar_unidade(&sim->recursos[RECURSO_PISTA], &estado));
+    add_resource_holder(sim, aviao_id, RECURSO_PISTA);
+}
+
+static int pistas_livres(simulacao_t* sim) {
+    return ESTADO_LIVRES(atomic_load(&sim->recursos[RECURSO_PISTA].estado));
+}
+
+// A vítima de uma preempção termina e a posição dela é reutilizada entre
+// preemptar_voo e a devolução das unidades: o novo voo não pode perder as
+// suas.
+static void teste_preempcao_reuso() {
+    simulacao_t* sim = simulacao_preparada(NULL);
+    VERIFICAR(sim != NULL);
+    if (sim == NULL) return;
+    int capacidade = sim->recursos[RECURSO_PISTA].capacidade;
+    int vitima = 5, sucessor = 5 + sim->capacidade_voos;
+
+    airplane_t* plane = ocupar_posicao(sim, vitima, VOO_INTERNACIONAL);
+    reter_pista(sim, vitima);
+    unsigned retidos = 0;
+    VERIFICAR(preemptar_voo(sim, plane, vitima, 3, &retidos));
+    VERIFICAR(retidos == 1u << RECURSO_PISTA);
+    VERIFICAR(registro_voo(sim, vitima)->preemptado == 1);
+
+    // A vítima ainda tenta devolver a pista ao terminar; ela já foi tomada.
+    release_res(sim, RECURSO_PISTA, vitima);
+    VERIFICAR(pistas_livres(sim) == capacidade - 1);
+    concluir_voo(sim, plane, -1);
+
+    VERIFICAR(ocupar_posicao(sim, sucessor, VOO_DOMESTICO) == plane);
+    reter_pista(sim, sucessor);
+    VERIFICAR(!is_resource_holder(sim, vitima, RECURSO_PISTA));
+    VERIFICAR(is_resource_holder(sim, sucessor, RECURSO_PISTA));
+
+    devolver_retidos(sim, retidos);
+    VERIFICAR(is_resource_holder(sim, sucessor, RECURSO_PISTA));
+    VERIFICAR(pistas_livres(sim) == capacidade - 1);
+
+    // Preemptar pelo id antigo não atinge o novo ocupante.
+    VERIFICAR(!preemptar_voo(sim, plane, vitima, 3, &retidos));
+    VERIFICAR(force_preemption_by_id(sim, vitima) == -1);
+    VERIFICAR(is_resource_holder(sim, sucessor, RECURSO_PISTA));
+    VERIFICAR(registro_voo(sim, sucessor)->preemptado == 0);
+
+    release_res(sim, RECURSO_PISTA, sucessor);
+    VERIFICAR(pistas_livres(sim) == capacidade);
+    simulacao_destruir(sim);
+}
+
+// Um voo demorado na posição do próximo id não pode segurar a admissão
+// enquanto houver outras posições livres.
+static void teste_admissao_posicao_ocupada() {
+    simulacao_t* sim = simulacao_preparada(NULL);
+    VERIFICAR(sim != NULL);
+    if (sim == NULL) return;
+    sim->cfg.max_ativos = 0;
+
+    atomic_store(&sim->airplane_counter, sim->capacidade_voos + 3);
+    ocupar_posicao(sim, 3, VOO_DOMESTICO);
+    sim->ativos = 1;
+    VERIFICAR(ha_folga(sim));
+    VERIFICAR(proximo_id_livre(sim) == sim->capacidade_voos + 4);
+
+    // Com todas as posições ocupadas não há onde lançar.
+    for (int id = 0; id < sim->capacidade_voos; id++) {
+        if (id != 3) ocupar_posicao(sim, id, VOO_DOMESTICO);
+    }
+    sim->ativos = sim->capacidade_voos;
+    VERIFICAR(proximo_id_livre(sim) == -1);
+    VERIFICAR(!ha_folga(sim));
+
+    // O limite de ativos continua valendo mesmo com posições livres.
+    atomic_store(&voo(sim, 10)->ocupado, 0);
+    sim->ativos = sim->capacidade_voos - 1;
+    VERIFICAR(ha_folga(sim));
+    sim->cfg.max_ativos = sim->ativos;
+    VERIFICAR(!ha_folga(sim));
+
+    simulacao_destruir(sim);
+}
+
+// Um voo encerrado no meio da decolagem não conta como sucesso, e o sono do
+// serviço acaba logo no encerramento em vez de esperar o prazo.
+static void teste_servico_interrompido() {
+    simulacao_t* sim = simulacao_preparada(NULL);
+    VERIFICAR(sim != NULL);
+    if (sim == NULL) return;
+    sim->cfg.saida = NULL;
+    simulacao_definir_servico(sim, "decolagem", "DOM", "uniforme:60:60");
+
+    airplane_t* plane = ocupar_posicao(sim, 4, VOO_DOMESTICO);
+    registro_voo_t* registro = registro_voo(sim, 4);
+    for (int f = 0; f < NUM_FASES; f++) registro->concessao[f] = -1;
+    plane->sim = sim;
+    plane->requisitos = sim->requisitos_por_tipo[VOO_DOMESTICO];
+    plane->fase_inicial = FASE_DECOLAGEM;
+    plane->retomado = 1;
+    atomic_store(&plane->tempo_inicio, time(NULL));
+    atomic_store(&plane->recurso_esperado, -1);
+    sim->ativos = 1;
+
+    long long inicio = agora_ns();
+    pthread_t thread;
+    VERIFICAR(pthread_create(&thread, NULL, airplane_thread, plane) == 0);
+    registro_voo_t copia;
+    for (int i = 0; i < 500; i++) {
+        ler_registro(plane, registro, &copia);
+        if (copia.concessao[FASE_DECOLAGEM] != -1) break;
+        usleep(10000);
+    }
+    VERIFICAR(copia.concessao[FASE_DECOLAGEM] != -1);
+    encerrar_simulacao(sim);
+    notificar_encerramento(sim);
+    pthread_join(thread, NULL);
+
+    VERIFICAR(agora_ns() - inicio < 10000000000LL);
+    VERIFICAR(sim->sucessos == 0 && sim->quedas == 1);
+    VERIFICAR(sim->despejo_n == 1 && REGISTRO_ESTADO(&sim->despejo[0]) == -1);
+    VERIFICAR(pistas_livres(sim) == sim->recursos[RECURSO_PISTA].capacidade);
+    simulacao_destruir(sim);
+}
+
+#define CPU_POR_THREAD_NS 20000000LL
+
+static long long cpu_thread_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Gasta CPU_POR_THREAD_NS de CPU da própria thread.
+static void gastar_cpu() {
+    volatile unsigned long long x = 0;
+    long long fim = cpu_thread_ns() + CPU_POR_THREAD_NS;
+    while (cpu_thread_ns() < fim) x++;
+}
+
+typedef struct {
+    simulacao_t* sim;
+    int despertares;
+} papel_teste_t;
+
+static void* thread_papel(void* arg) {
+    papel_teste_t* p = arg;
+    gastar_cpu();
+    despertares_thread += p->despertares;
+    contabilizar_thread(p->sim, PAPEL_AVIOES, NULL);
+    return NULL;
+}
+
+static void teste_consumo() {
+    simulacao_t* sim = simulacao_criar(NULL);
+    pthread_t threads[4];
+    papel_teste_t papeis[4];
+    for (int i = 0; i < 4; i++) {
+        papeis[i].sim = sim;
+        papeis[i].despertares = i + 1;
+        pthread_create(&threads[i], NULL, thread_papel, &papeis[i]);
+    }
+    for (int i = 0; i < 4; i++) pthread_join(threads[i], NULL);
+
+    // Os totais do papel somam o que cada thread mediu de si mesma.
+    const consumo_thread_t* avioes = &sim->consumo[PAPEL_AVIOES];
+    VERIFICAR(avioes->threads == 4);
+    VERIFICAR(avioes->despertares == 1 + 2 + 3 + 4);
+    VERIFICAR(avioes->cpu_ns >= 4 * CPU_POR_THREAD_NS);
+    VERIFICAR(avioes->trocas_voluntarias >= 0 && avioes->trocas_involuntarias >= 0);
+
+    // Com inicio, só conta o consumo posterior à medição inicial.
+    consumo_thread_t inicio;
+    gastar_cpu();
+    despertares_thread += 100;
+    medir_thread(&inicio);
+    gastar_cpu();
+    despertares_thread += 3;
+    contabilizar_thread(sim, PAPEL_GERADOR, &inicio);
+    long long depois_ns = cpu_thread_ns();
+    const consumo_thread_t* gerador = &sim->consumo[PAPEL_GERADOR];
+    VERIFICAR(gerador->threads == 1);
+    VERIFICAR(gerador->despertares == 3);
+    VERIFICAR(gerador->cpu_ns >= CPU_POR_THREAD_NS);
+    VERIFICAR(gerador->cpu_ns <= depois_ns - inicio.cpu_ns);
+
+    for (int p = 0; p < NUM_PAPEIS; p++) {
+        if (p != PAPEL_AVIOES && p != PAPEL_GERADOR) VERIFICAR(sim->consumo[p].threads == 0);
+    }
+
+    // O relatório lista só os papéis com threads.
+    char texto[2048] = "";
+    FILE* saida = fmemopen(texto, sizeof(texto) - 1, "w");
+    VERIFICAR(saida != NULL);
+    if (saida != NULL) {
+        imprimir_consumo(sim, saida);
+        fclose(saida);
+        VERIFICAR(strstr(texto, "\navioes ") != NULL);
+        VERIFICAR(strstr(texto, "\ngerador ") != NULL);
+        VERIFICAR(strstr(texto, "\nroda ") == NULL);
+    }
+    simulacao_destruir(sim);
+}
+
+int main() {
+    teste_quantil_normal();
+    teste_servicos();
+    teste_politicas();
+    teste_intervalo_confianca();
+    teste_roda();
+    teste_estado_recurso();
+    teste_checkpoint();
+    teste_retomada_tabela();
+    teste_registro_concorrente();
+    teste_consumo();
+    teste_preempcao_reuso();
+    teste_admissao_posicao_ocupada();
+    teste_servico_interrompido();
+
+    printf("%d verificacoes, %d falhas\n", verificacoes, falhas);
+    return falhas == 0 ? 0 : 1;
+}